@@ -13,6 +13,9 @@ Note: C++ destructors of global objects are NOT yet supported in the HIWARE Obje
 #define __NO_FLAGS_OFFSET       /* we do not need the flags field in the startup data descriptor */
 #define __NO_MAIN_OFFSET        /* we do not need the main field in the startup data descriptor */
 #define __NO_STACKOFFSET_OFFSET /* we do not need the stackOffset field in the startup data descriptor */
+#define _DO_PAINT_STACK_        /* fill SSTACK with STACK_PAINT_WORD for the stack monitor (stackmon.c) */
+#define _DO_FAST_INIT_          /* word-wise zero out and copy down, also in -os builds */
+#define _DO_TIME_STARTUP_       /* start TCNT at bus clock so main() can read the startup time */
 
 /*#define __BANKED_COPY_DOWN : allow to allocate .copy in flash area */
 #if defined(__BANKED_COPY_DOWN) && (!defined(__HCS12X__) || !defined(__ELF_OBJECT_FILE_FORMAT__))
@@ -22,6 +25,17 @@ Note: C++ destructors of global objects are NOT yet supported in the HIWARE Obje
 
 #include "hidef.h"
 #include "start12.h"
+#if defined(_DO_PAINT_STACK_)
+#include "stackmon.h"
+__SEG_START_DEF(SSTACK); /* lowest address of the stack, defined by the linker */
+#endif
+#if defined(_DO_TIME_STARTUP_)
+#include "derivative.h"
+#endif
+
+#if defined(__OPTIMIZE_FOR_SIZE__) && !defined(_DO_FAST_INIT_)
+#define __INIT_BYTEWISE__       /* Init loops selected below */
+#endif
 
 /***************************************************************************/
 /* Macros to control how the startup code handles the COP:                 */
@@ -45,6 +59,24 @@ Note: C++ destructors of global objects are NOT yet supported in the HIWARE Obje
 /* "L1128: Cutting value _Range beg data member from 0xF01000 to 0x1000"   */
 /* and this startup code writes to the cutted address                      */
 /***************************************************************************/
+/* _DO_PAINT_STACK_ define:                                                */
+/* Before Init is called, the whole SSTACK segment below the initial stack */
+/* pointer is filled with STACK_PAINT_WORD (stackmon.h). The stack monitor */
+/* finds the high-water mark as the lowest byte no longer holding the      */
+/* pattern.                                                                */
+/***************************************************************************/
+/* _DO_FAST_INIT_ define:                                                  */
+/* Init uses the __OPTIMIZE_FOR_TIME__ loops (STX/MOVW per word, one byte  */
+/* for odd sizes) regardless of -os/-ot. This halves the loop count for    */
+/* zero out and copy down at the cost of a few bytes of code.              */
+/* Segments placed into a NO_INIT area in the prm file (NO_INIT_DATA) get  */
+/* no zero out entry at all and keep their contents over a reset.          */
+/***************************************************************************/
+/* _DO_TIME_STARTUP_ define:                                               */
+/* The timer is enabled with prescaler 1 right after the stack pointer is  */
+/* set. TCNT read at the top of main() is then the number of bus cycles    */
+/* spent in stack painting, Init and the call to main (control.c reports). */
+/***************************************************************************/
 /* __BANKED_COPY_DOWN define:                                              */
 /* by default, the startup code assumes that the startup data structure    */
 /* _startupData, the zero out areas and the .copy section are all          */
@@ -166,7 +198,7 @@ NextZeroOut: PSHY                           ; save nofZeroOuts
 #if defined(__HCS12X__) && defined(FAR_DATA)
              PSHX
              LDX   0,X                      ; byte count
-#if defined(__OPTIMIZE_FOR_SIZE__)
+#if defined(__INIT_BYTEWISE__)
              CLRA
 NextWord:    GSTAA 1,Y+                     ; clear memory byte
              __FEED_COP_IN_HLI()            ; feed the COP if necessary /*lint !e505 !e522 asm code */
@@ -185,7 +217,7 @@ LastClr:
 #endif
              PULX
              LEAX  2,X
-#elif defined(__OPTIMIZE_FOR_SIZE__)               /* -os, default */
+#elif defined(__INIT_BYTEWISE__)                 /* -os, default */
              LDD   2,X+                     ; byte count
 NextWord:    CLR   1,Y+                     ; clear memory byte
              __FEED_COP_IN_HLI()            ; feed the COP if necessary /*lint !e505 !e522 asm code */
@@ -236,7 +268,7 @@ NextBlock:
 #endif /* FAR_DATA */
 
 #if defined(__HCS12X__) && defined(FAR_DATA)
-#if defined(__OPTIMIZE_FOR_SIZE__)               /* -os, default */
+#if defined(__INIT_BYTEWISE__)                   /* -os, default */
 Copy:        PSHA
              LDAA  1,X+
              GSTAA  1,Y+                    ; move a byte from ROM to the data area
@@ -258,7 +290,7 @@ Copy1:
              LDAA  1,X+
              GSTAA  1,Y+                    ; move a byte from ROM to the data area
 #endif
-#elif defined(__OPTIMIZE_FOR_SIZE__)               /* -os, default */
+#elif defined(__INIT_BYTEWISE__)                 /* -os, default */
 Copy:        MOVB  1,X+,1,Y+                ; move a byte from ROM to the data area
              __FEED_COP_IN_HLI()            ; feed the COP if necessary /*lint !e505 !e522 asm code */
              DBNE  D,Copy                   ; copy-byte loop
@@ -413,6 +445,10 @@ __EXTERN_C void _Startup(void) {
    /*lint -e{960} , MISRA 14.3 REQ, macro INIT_SP_FROM_STARTUP_DESC() expands to HLI code */ 
    /*lint -e{522} , MISRA 14.2 REQ, macro INIT_SP_FROM_STARTUP_DESC() expands to HLI code */    
    INIT_SP_FROM_STARTUP_DESC(); /* HLI macro definition in hidef.h */
+#if defined(_DO_TIME_STARTUP_)
+   TSCR2 = 0x00;           /* prescaler 1, TCNT counts bus cycles */
+   TSCR1 = TSCR1_TEN_MASK; /* TCNT starts from 0 after reset */
+#endif
 #if defined(_HCS12_SERIALMON)
    /* for Monitor based software remap the RAM & EEPROM to adhere
       to EB386. Edit RAM and EEPROM sections in PRM file to match these. */
@@ -421,6 +457,22 @@ __EXTERN_C void _Startup(void) {
    ___INITEE = 0x09;  /* lock EEPROM block to end at 0x0fff */
 #endif
 
+#if defined(_DO_PAINT_STACK_)
+   /* paint the stack before anything is pushed on it */
+   asm {
+             TFR   SP,D
+             SUBD  #__SEG_START_REF(SSTACK) ; bytes below the initial stack pointer
+             LSRD                           ; /2, the segment is word aligned
+             BEQ   PaintDone
+             TFR   D,Y                      ; word count
+             LDX   #__SEG_START_REF(SSTACK)
+             LDD   #STACK_PAINT_WORD
+PaintStack:  STD   2,X+
+             DBNE  Y,PaintStack
+PaintDone:
+   }
+#endif
+
    /* Here user defined code could be inserted, the stack could be used */
 #if defined(_DO_DISABLE_COP_)
    _DISABLE_COP();
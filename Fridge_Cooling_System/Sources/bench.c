@@ -0,0 +1,214 @@
+// filename  ***************  bench.c  ****************************
+// On-target cycle benchmarks, started with SCI commands
+
+#include <hidef.h>
+#include "derivative.h"      /* derivative-specific definitions */
+#include "bench.h"
+#include "hal.h"
+#include "sci1.h"
+#include "fixpt.h"
+#include "pool.h"
+#ifdef BENCH_FLOAT
+#include <stdio.h>
+#endif
+
+
+#define BENCH_MAX   256
+
+// Source table in paged flash, read through far pointers
+#pragma CONST_SEG __PPAGE_SEG PAGED_CONST
+static const unsigned char benchTable[BENCH_MAX + 2] = {
+  0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+  0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF
+};
+#pragma CONST_SEG DEFAULT
+
+POOL_CHECK(bench_buffer, POOL_BUFFER_SIZE >= BENCH_MAX + 2);  // copy destination
+POOL_CHECK(bench_text, POOL_TEXT_SIZE >= 16);                 // "%.2f" of a float
+
+// _FAR_COPY arguments, kept in globals so the HLI below needs no stack offsets
+static const unsigned char *__far benchSrc;
+static unsigned char *benchDst;
+static unsigned short benchSize;
+
+static const unsigned short benchSizes[] = { 1, 2, 7, 16, 64, 255 };
+
+// Fixed-point operands, volatile so nothing is folded at compile time
+static volatile unsigned char benchAtd = 14;
+static volatile Fix benchFixA = 0x1B73;   // 27.45
+static volatile Fix benchFixB = -0x0340;  // -3.25
+static volatile char benchFixResult;
+#ifdef BENCH_FLOAT
+static volatile float benchFloatA = 27.45f;
+static volatile float benchFloatB = -3.25f;
+#endif
+
+extern void __near _FAR_COPY(void);  // datapage.c, size passed on the stack
+
+
+//-------------------------Bench_Begin/Bench_End---------------
+// Switch TCNT to bus cycles for the measurement and back afterwards.
+// The counts in between are not HAL_TICKS time and are dropped, the
+// real-time clock and the recorder lose the measurement's run time.
+static unsigned char savedTSCR2;
+
+static void Bench_Begin(void) {
+  __asm SEI;
+  (void)HAL_Ticks();   // count up to here at the normal prescaler
+  savedTSCR2 = TSCR2;
+  TSCR2 = savedTSCR2 & ~0x07;   // prescaler 1
+}
+
+static void Bench_End(void) {
+  TSCR2 = savedTSCR2;
+  HAL_TicksSkip();
+  __asm CLI;
+}
+
+//-------------------------Bench_RunFarCopy--------------------
+// One _FAR_COPY call
+// Input: none (benchSrc, benchDst, benchSize)
+// Output: bus cycles
+static unsigned short Bench_RunFarCopy(void) {
+  unsigned short t0, t1;
+
+  t0 = TCNT;
+  asm {
+        LDX   benchSize
+        PSHX                      ; size argument of _FAR_COPY
+        LDX   benchSrc:1          ; source offset
+        LDAA  benchSrc:0          ; source page
+        LDY   benchDst            ; destination offset
+        CLRB                      ; destination page (RAM, not paged)
+        JSR   _FAR_COPY           ; releases the size argument itself
+  }
+  t1 = TCNT;
+  return t1 - t0;
+}
+
+//-------------------------Bench_RunByteLoop-------------------
+// The same copy as a C loop through a far pointer, i.e. one paged load
+// (_LOAD_FAR_8 or inline page switching) per byte
+// Input: none (benchSrc, benchDst, benchSize)
+// Output: bus cycles
+static unsigned short Bench_RunByteLoop(void) {
+  const unsigned char *__far s = benchSrc;
+  unsigned char *d = benchDst;
+  unsigned short n = benchSize;
+  unsigned short t0, t1;
+
+  t0 = TCNT;
+  while (n--) {
+    *d++ = *s++;
+  }
+  t1 = TCNT;
+  return t1 - t0;
+}
+
+//-------------------------Bench_FarCopy-----------------------
+// Times _FAR_COPY from paged flash to RAM against a byte loop through a
+// far pointer, for several sizes and source/destination alignments
+// Input: none
+// Output: table printed over SCI1, cycles include the call overhead
+void Bench_FarCopy(void) {
+  unsigned char i, align;
+  unsigned short copy, loop;
+  unsigned char *buf = Pool_Alloc(POOL_BUFFER);
+
+  if (buf == 0) {
+    SCI1_OutString("no buffer");SCI1_OutChar(CR);SCI1_OutChar(LF);
+    return;
+  }
+  SCI1_OutString("size src dst _FAR_COPY byteloop");SCI1_OutChar(CR);SCI1_OutChar(LF);
+  for (i = 0; i < sizeof(benchSizes) / sizeof(benchSizes[0]); i++) {
+    for (align = 0; align < 4; align++) {
+      benchSrc = &benchTable[align & 1];
+      benchDst = &buf[(align >> 1) & 1];
+      benchSize = benchSizes[i];
+
+      Bench_Begin();
+      copy = Bench_RunFarCopy();
+      loop = Bench_RunByteLoop();
+      Bench_End();
+
+      SCI1_OutUDec(benchSize);
+      SCI1_OutString((align & 1) ? " odd  " : " even ");
+      SCI1_OutString((align & 2) ? "odd  " : "even ");
+      SCI1_OutUDec(copy);SCI1_OutChar(' ');
+      SCI1_OutUDec(loop);SCI1_OutChar(CR);SCI1_OutChar(LF);
+    }
+  }
+  Pool_Free(POOL_BUFFER, buf);
+}
+
+// One row of the fixed-point table
+static void Bench_FixRow(char *name, unsigned short fix, unsigned short flt) {
+  SCI1_OutString(name);SCI1_OutUDec(fix);
+#ifdef BENCH_FLOAT
+  SCI1_OutChar(' ');SCI1_OutUDec(flt);
+#else
+  (void)flt;
+#endif
+  SCI1_OutChar(CR);SCI1_OutChar(LF);
+}
+
+//-------------------------Bench_FixedPoint--------------------
+// Times the Q8.8 operations the firmware uses: the overheat check on a
+// sensor reading, multiply, divide and two-decimal formatting. Built
+// with BENCH_FLOAT (which links the soft-float runtime and printf with
+// float support again) it times the float code they replaced as well;
+// the code size difference shows in the two builds' Project.map.
+// Input: none
+// Output: table printed over SCI1, cycles include the call overhead
+void Bench_FixedPoint(void) {
+  unsigned short t0, fix[4], flt[4];
+  unsigned char i;
+  char *text = Pool_Alloc(POOL_TEXT);
+
+  if (text == 0) {
+    SCI1_OutString("no buffer");SCI1_OutChar(CR);SCI1_OutChar(LF);
+    return;
+  }
+  Bench_Begin();
+  t0 = TCNT;
+  benchFixResult = Fix_Ratio(benchAtd * 100L, 51) > FIX_INT(27);
+  fix[0] = TCNT - t0;
+  t0 = TCNT;
+  benchFixA = Fix_Mul(benchFixA, benchFixB);
+  fix[1] = TCNT - t0;
+  t0 = TCNT;
+  benchFixA = Fix_Div(benchFixA, benchFixB);
+  fix[2] = TCNT - t0;
+  t0 = TCNT;
+  (void)Fix_Format(text, benchFixA, 2);
+  fix[3] = TCNT - t0;
+  for (i = 0; i < 4; i++) {
+    flt[i] = 0;
+  }
+#ifdef BENCH_FLOAT
+  t0 = TCNT;
+  benchFixResult = (benchAtd * 100.0) / 51 > 27;
+  flt[0] = TCNT - t0;
+  t0 = TCNT;
+  benchFloatA = benchFloatA * benchFloatB;
+  flt[1] = TCNT - t0;
+  t0 = TCNT;
+  benchFloatA = benchFloatA / benchFloatB;
+  flt[2] = TCNT - t0;
+  t0 = TCNT;
+  (void)sprintf(text, "%.2f", benchFloatA);
+  flt[3] = TCNT - t0;
+#endif
+  Bench_End();
+  Pool_Free(POOL_TEXT, text);
+
+#ifdef BENCH_FLOAT
+  SCI1_OutString("op       Q8.8 float");SCI1_OutChar(CR);SCI1_OutChar(LF);
+#else
+  SCI1_OutString("op       Q8.8");SCI1_OutChar(CR);SCI1_OutChar(LF);
+#endif
+  Bench_FixRow("overheat ", fix[0], flt[0]);
+  Bench_FixRow("multiply ", fix[1], flt[1]);
+  Bench_FixRow("divide   ", fix[2], flt[2]);
+  Bench_FixRow("format   ", fix[3], flt[3]);
+}
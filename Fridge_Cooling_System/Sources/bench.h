@@ -0,0 +1,20 @@
+// filename  ***************  bench.h  ****************************
+// On-target cycle benchmarks, started with SCI commands
+//
+// Each benchmark runs with interrupts masked and the timer prescaler
+// temporarily set to 1, so TCNT counts bus cycles. Output compare
+// events due during a run are delayed until it ends.
+
+//-------------------------Bench_FarCopy-----------------------
+// Times _FAR_COPY from paged flash to RAM against a byte loop through a
+// far pointer, for several sizes and source/destination alignments
+// Input: none
+// Output: table printed over SCI1, cycles include the call overhead
+extern void Bench_FarCopy(void);
+
+//-------------------------Bench_FixedPoint--------------------
+// Times the Q8.8 operations the firmware uses; with BENCH_FLOAT defined
+// also the float code they replaced (links the soft-float runtime)
+// Input: none
+// Output: table printed over SCI1, cycles include the call overhead
+extern void Bench_FixedPoint(void);
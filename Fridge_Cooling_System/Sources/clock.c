@@ -0,0 +1,164 @@
+// filename  ***************  clock.c  ****************************
+// Run-time bus clock scaling (see clock.h)
+//
+// The main loop spends most of its time in HAL_DELAY_MS and HAL_IDLE
+// polls; there the bus runs at CLOCK_LOW_HZ. Work that wants the full
+// clock (serial commands and dumps) opens a Clock_Burst.
+// Every switch relocks the PLL with interrupts masked, so the relock
+// time is also the interrupt latency it costs. The clock only drops
+// CLOCK_DWELL_MS after the last burst ended, so a main loop pass that
+// bursts doesn't relock twice, and never while the SCI is still sending:
+// Clock_Idle leaves that to a later poll. Clock_Report prints the relock
+// time next to the share of time at each speed, the bus frequency
+// averaged over time stands in for the supply current (CMOS, about linear).
+
+#include "hal.h"
+#include "sci1.h"
+
+// TCNT keeps its rate at the low clock, see clock.h
+typedef char clockLowTimerCheck[(CLOCK_LOW_HZ >> CLOCK_LOW_TIMER_PR) == CLOCK_TIMER_HZ ? 1 : -1];
+typedef char clockLowMdcCheck[CLOCK_LOW_HZ / 4 == CLOCK_MDC_HZ ? 1 : -1];
+
+static unsigned char mode;           // CLOCK_FULL or CLOCK_LOW
+static unsigned char bursts;         // open Clock_Burst calls
+static unsigned long since;          // HAL_TICKS at the last switch
+static unsigned long burstEnd;       // HAL_TICKS when the last burst closed
+static unsigned long inMode[2];      // ticks spent at each speed
+static unsigned short switches;      // relocks since Clock_Init
+static unsigned short lockLast, lockMax;   // relock time, CLOCK_OSC_TICK_US ticks
+
+// Charges the time since the last switch to the current mode
+static void account(void) {
+  unsigned long now = HAL_TICKS();
+
+  inMode[mode] += now - since;
+  since = now;
+  if ((inMode[0] | inMode[1]) & 0x80000000UL) {
+    inMode[0] >>= 1;   // keep the ratio, not the totals
+    inMode[1] >>= 1;
+  }
+}
+
+// Relocks for the new mode with the transmitter idle, so no byte goes
+// out half at the old baud rate. The wait runs with interrupts enabled,
+// only the relock itself is masked.
+static void switchTo(unsigned char m) {
+  unsigned char ccr;
+
+  for (;;) {
+    while (!HAL_SCI_TX_IDLE()) {};
+    HAL_CRITICAL_ENTER(ccr);
+    if (HAL_SCI_TX_IDLE()) {
+      break;
+    }
+    HAL_CRITICAL_EXIT(ccr);   // a handler sent a byte meanwhile
+  }
+  account();
+  lockLast = HAL_CLOCK_SELECT(m);
+  mode = m;
+  SCI1_Retune();
+  HAL_CRITICAL_EXIT(ccr);
+  if (lockLast > lockMax) {
+    lockMax = lockLast;
+  }
+  switches++;
+}
+
+//-------------------------Clock_Init-------------------------
+// Full speed (HAL_CLOCK_INIT), no burst open, statistics cleared; first
+// thing in main(), before the SCI baud divisor is set
+// Start-up counts as a burst: the keypad dialog and the peripheral setup
+// run at full speed until Control_Main closes it.
+// Input: none
+// Output: none
+void Clock_Init(void) {
+
+  HAL_CLOCK_INIT();
+  mode = CLOCK_FULL;
+  bursts = 1;
+  since = burstEnd = HAL_TICKS();
+  inMode[CLOCK_FULL] = inMode[CLOCK_LOW] = 0;
+  switches = lockLast = lockMax = 0;
+}
+
+//-------------------------Clock_Burst------------------------
+// Full speed until the matching Clock_BurstEnd, calls nest
+// Input: none
+// Output: none
+void Clock_Burst(void) {
+
+  if (bursts < 255) {
+    bursts++;
+  }
+  if (mode != CLOCK_FULL) {
+    switchTo(CLOCK_FULL);
+  }
+}
+
+//-------------------------Clock_BurstEnd---------------------
+// Closes a Clock_Burst, the clock drops at a Clock_Idle CLOCK_DWELL_MS
+// after the last one closed
+// Input: none
+// Output: none
+void Clock_BurstEnd(void) {
+
+  if (bursts > 0 && --bursts == 0) {
+    burstEnd = HAL_TICKS();
+  }
+}
+
+//-------------------------Clock_Idle-------------------------
+// Low clock unless a burst is open or closed less than CLOCK_DWELL_MS
+// ago, or the SCI is still sending; HAL_IDLE calls it on every poll
+// Input: none
+// Output: none
+void Clock_Idle(void) {
+
+  if (bursts == 0 && mode != CLOCK_LOW && HAL_SCI_TX_IDLE() &&
+      HAL_TICKS() - burstEnd >= CLOCK_DWELL_TICKS) {
+    switchTo(CLOCK_LOW);
+  }
+}
+
+//-------------------------Clock_BusHz------------------------
+// Bus frequency of the current mode
+// Input: none
+// Output: Hz
+unsigned long Clock_BusHz(void) {
+  return mode == CLOCK_LOW ? CLOCK_LOW_HZ : CLOCK_BUS_HZ;
+}
+
+// Prints tenths as "x.y"
+static void outTenths(unsigned short n) {
+  SCI1_OutUDec(n / 10);SCI1_OutChar('.');SCI1_OutUDec(n % 10);
+}
+
+//-------------------------Clock_Report-----------------------
+// Prints switches, PLL relock time and the share of time at each speed
+// over SCI1
+// Input: none
+// Output: none
+void Clock_Report(void) {
+  unsigned long total;
+  unsigned short full;   // per mille of the time at CLOCK_BUS_HZ
+
+  account();
+  total = inMode[CLOCK_FULL] + inMode[CLOCK_LOW];
+  full = total ? (unsigned short)(inMode[CLOCK_FULL] / (total / 1000 + 1)) : 1000;
+  if (full > 1000) {
+    full = 1000;
+  }
+  SCI1_OutString("Clock switches ");SCI1_OutUDec(switches);
+  SCI1_OutString(", relock us last ");SCI1_OutUDec(lockLast * CLOCK_OSC_TICK_US);
+  SCI1_OutString(" max ");SCI1_OutUDec(lockMax * CLOCK_OSC_TICK_US);
+  SCI1_OutChar(CR);SCI1_OutChar(LF);
+  SCI1_OutString("  ");outTenths((unsigned short)(CLOCK_BUS_HZ / 100000UL));
+  SCI1_OutString(" MHz ");outTenths(full);
+  SCI1_OutString(" %, ");outTenths((unsigned short)(CLOCK_LOW_HZ / 100000UL));
+  SCI1_OutString(" MHz ");outTenths(1000 - full);
+  SCI1_OutString(" %, mean bus ");
+  outTenths((unsigned short)(((unsigned long)full * (CLOCK_BUS_HZ / 100000UL) +
+            (unsigned long)(1000 - full) * (CLOCK_LOW_HZ / 100000UL)) / 1000));
+  SCI1_OutString(" MHz");
+  SCI1_OutChar(CR);SCI1_OutChar(LF);
+}
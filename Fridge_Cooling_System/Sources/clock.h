@@ -0,0 +1,108 @@
+// filename  ***************  clock.h  ****************************
+// Clock configuration and everything derived from the bus frequency
+//
+// HAL_CLOCK_INIT() (hal.h) runs the CRG PLL from the Dragon12 crystal:
+//   PLLCLK = 2 * OSCCLK * (SYNR + 1) / (REFDV + 1), bus = PLLCLK / 2
+// Baud divisors, the timer prescaler, the ATD prescaler and the delay
+// loop are computed from CLOCK_BUS_HZ at compile time, so changing
+// SYNR/REFDV here is the only edit a different bus clock needs.
+// The EEPROM and RTI dividers use OSCCLK, they don't depend on the PLL.
+//
+// At run time clock.c drops the bus to CLOCK_LOW_HZ while the main loop
+// idles and goes back to CLOCK_BUS_HZ for bursts of work (Clock_Burst).
+// The low clock keeps TCNT at CLOCK_TIMER_HZ and the system tick at
+// CLOCK_MDC_HZ, so compares, tick counts and trace stamps mean the same
+// at both speeds; the baud divisor, the
+// ATD prescaler and the delay loop are switched with it (the _AT forms).
+// Only macros and prototypes here, hal.h includes this file.
+
+#define CLOCK_OSC_HZ      8000000UL   // OSCCLK, Dragon12 crystal
+#define CLOCK_SYNR        2
+#define CLOCK_REFDV       0
+#define CLOCK_PLL_HZ      (2UL * CLOCK_OSC_HZ * (CLOCK_SYNR + 1) / (CLOCK_REFDV + 1))
+#define CLOCK_BUS_HZ      (CLOCK_PLL_HZ / 2)   // 24 MHz
+
+// Timer: TCNT = bus / 2^CLOCK_TIMER_PR (TSCR2 PR2:0), 375 kHz
+#define CLOCK_TIMER_PR    6
+#define CLOCK_TIMER_HZ    (CLOCK_BUS_HZ >> CLOCK_TIMER_PR)
+#define CLOCK_US_TO_TICKS(us)  ((unsigned short)(CLOCK_TIMER_HZ / 1000UL * (us) / 1000UL))
+
+// Low-power bus: same PLL, REFDV divides by 4 more, and the timer
+// prescaler by 4 less, TCNT stays at CLOCK_TIMER_HZ (checked in clock.c)
+#define CLOCK_LOW_REFDV   3
+#define CLOCK_LOW_HZ      (CLOCK_OSC_HZ * (CLOCK_SYNR + 1) / (CLOCK_LOW_REFDV + 1))   // 6 MHz
+#define CLOCK_LOW_TIMER_PR (CLOCK_TIMER_PR - 2)
+
+// While the PLL relocks the bus runs from OSCCLK / 2; the nearest TCNT
+// rate to CLOCK_TIMER_HZ there is 250 kHz, 4 us a tick
+#define CLOCK_OSC_BUS_HZ  (CLOCK_OSC_HZ / 2)
+#define CLOCK_OSC_TIMER_PR 4
+#define CLOCK_OSC_TICK_US ((unsigned short)(1000000UL / (CLOCK_OSC_BUS_HZ >> CLOCK_OSC_TIMER_PR)))
+
+// Modulus down-counter (system tick): bus / 16, 1.5 MHz; / 4 at the low
+// clock. A period is at most 65535 counts, 43 ms.
+#define CLOCK_MDC_PR      3   // MCCTL MCPR1:0, divide by 16
+#define CLOCK_LOW_MDC_PR  1   // divide by 4
+#define CLOCK_MDC_HZ      (CLOCK_BUS_HZ / 16)
+#define CLOCK_MS_TO_MDC(ms)    ((unsigned short)(CLOCK_MDC_HZ / 1000UL * (ms)))
+
+// Clock_ modes
+#define CLOCK_FULL        0   // CLOCK_BUS_HZ
+#define CLOCK_LOW         1   // CLOCK_LOW_HZ
+// Full speed held after the last Clock_BurstEnd, so back-to-back bursts
+// share one pair of relocks
+#define CLOCK_DWELL_MS    500
+#define CLOCK_DWELL_TICKS ((unsigned long)CLOCK_TIMER_HZ / 1000UL * CLOCK_DWELL_MS)
+
+// SCI: baud = bus / (16 * SBR), rounded to the nearest divisor
+#define CLOCK_SCI_SBR_AT(bus, baud) ((unsigned short)(((bus) / 16UL + (baud) / 2) / (baud)))
+#define CLOCK_SCI_SBR(baud)    CLOCK_SCI_SBR_AT(CLOCK_BUS_HZ, baud)
+
+// ATD: conversion clock = bus / (2 * (PRS + 1)), at most 2 MHz
+#define CLOCK_ATD_PRS_AT(bus) ((unsigned char)(((bus) + 3999999UL) / 4000000UL - 1))
+#define CLOCK_ATD_PRS     CLOCK_ATD_PRS_AT(CLOCK_BUS_HZ)
+
+// HAL_DelayMs: one pass of its inner loop takes CLOCK_DELAY_LOOP_CYCLES
+#define CLOCK_DELAY_LOOP_CYCLES  17
+#define CLOCK_DELAY_LOOPS_AT(bus) ((unsigned short)((bus) / 1000UL / CLOCK_DELAY_LOOP_CYCLES))
+#define CLOCK_DELAY_LOOPS CLOCK_DELAY_LOOPS_AT(CLOCK_BUS_HZ)
+
+//-------------------------Clock_Init-------------------------
+// Full speed (HAL_CLOCK_INIT), no burst open, statistics cleared; first
+// thing in main(), before the SCI baud divisor is set
+// Input: none
+// Output: none
+extern void Clock_Init(void);
+
+//-------------------------Clock_Burst------------------------
+// Full speed until the matching Clock_BurstEnd, calls nest
+// Input: none
+// Output: none
+extern void Clock_Burst(void);
+
+//-------------------------Clock_BurstEnd---------------------
+// Closes a Clock_Burst, the clock drops at a Clock_Idle CLOCK_DWELL_MS
+// after the last one closed
+// Input: none
+// Output: none
+extern void Clock_BurstEnd(void);
+
+//-------------------------Clock_Idle-------------------------
+// Low clock unless a burst is open or closed less than CLOCK_DWELL_MS
+// ago, or the SCI is still sending; HAL_IDLE calls it on every poll
+// Input: none
+// Output: none
+extern void Clock_Idle(void);
+
+//-------------------------Clock_BusHz------------------------
+// Bus frequency of the current mode
+// Input: none
+// Output: Hz
+extern unsigned long Clock_BusHz(void);
+
+//-------------------------Clock_Report-----------------------
+// Prints switches, PLL relock time and the share of time at each speed
+// over SCI1
+// Input: none
+// Output: none
+extern void Clock_Report(void);
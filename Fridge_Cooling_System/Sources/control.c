@@ -0,0 +1,630 @@
+// filename  ***************  control.c  ***************************
+// Fridge control application: zone setup, fan duty, door and power
+// handling, history logging and the operator messages
+//
+// Everything here reaches the hardware through hal.h, so this file builds
+// for the MC9S12DP256 and, with HAL_HOST, on a host (host/Makefile).
+// main.c holds the interrupt vectors, which call the Control_ handlers.
+
+#include "hal.h"        /* hardware abstraction (registers, delays, restart) */
+#include "control.h"
+#include "lcd.h" 				/* include lcd library definitions */
+#include "sci1.h"       /* include serial communication interface definitions */
+#include "porth.h"      /* include debounced DIP switch input service */
+#include "eeprom.h"     /* include on-chip EEPROM driver */
+#include "settings.h"   /* include persisted zone configuration */
+#include "eelog.h"      /* include EEPROM temperature/fault history */
+#include "stackmon.h"   /* include stack watermark monitor */
+#include "bench.h"      /* include on-target cycle benchmarks */
+#include "isrstat.h"    /* include ISR timing statistics */
+#include "trace.h"      /* include RAM event trace */
+#include "prof.h"       /* include PC-sampling profiler */
+#include "fixpt.h"      /* include Q8.8 fixed-point arithmetic */
+#include "spsc.h"       /* include lock-free ISR-to-main queues */
+#include "state.h"      /* include double-buffered settings and temperature */
+#include "pool.h"       /* include fixed-block memory pools */
+#include "msgs.h"       /* include numbered operator messages */
+#include "rtc.h"        /* include soft real-time clock */
+#include "sched.h"      /* include time-of-day set point schedule */
+#include "fan.h"        /* include output compare fan PWM */
+
+
+/******* Constants *******/
+const unsigned short fs_ON[4] = { 0, FAN_DUTY_PM(78), FAN_DUTY_PM(392), FAN_PERIOD }; // Fan high time per speed level (OFF, 1, 2, 3)
+const unsigned short log_period = 60000 / CONTROL_PERIOD_MS; // Control periods between history samples (60 s)
+const Fix overheat_c = FIX_INT(27); // Room temperature (C) that stops the controller
+typedef char control_rate_check[CONTROL_TICK_MS <= 43 && CONTROL_PERIOD_MS % CONTROL_TICK_MS == 0 &&
+                                CONTROL_PERIOD_MS / CONTROL_TICK_MS <= 255 ? 1 : -1]; // control.h
+
+
+/******* Global variables *******/
+// Zone settings, current temperature and ref_has_started: State_Now() (state.h)
+volatile unsigned char is_ref_on, is_door_open; // Refregirator status
+volatile unsigned char f1_level; // Zone 1 fan speed level
+volatile unsigned char f2_level; // Zone 2 fan speed level
+volatile unsigned char log_due; // Set when a history sample is due
+unsigned short log_ticks; // Control periods since the last history sample
+unsigned char control_ticks; // System ticks since the last control period
+SPSC_DEFINE(atd_samples, unsigned char, 8); // Sensor readings, system tick ISR to log_history
+unsigned long atd_sum; // Sum of the readings taken from atd_samples since the last history sample
+unsigned short atd_count; // Readings in atd_sum
+typedef struct { unsigned char id, a, b; } Report; // MSG_Send arguments
+SPSC_DEFINE(reports, Report, 16); // Operator messages, control law to send_reports
+unsigned char atd_last; // Last reading, the logged mean once a sample is written
+unsigned char starts; // main() entries since reset
+unsigned char ee_errors; // EEPROM errors already logged
+unsigned char stack_overflow_logged; // Stack red zone hit already logged
+unsigned short startup_cycles; // Bus cycles from reset to main() (_DO_TIME_STARTUP_ in Start12.c)
+
+#pragma DATA_SEG NO_INIT_DATA // Not zeroed at reset (Project.prm)
+unsigned short resets; // Resets since power-on
+unsigned short resets_check; // ~resets while valid, RAM holds garbage after power-on
+#pragma DATA_SEG DEFAULT
+
+
+/******* Function Headers *******/
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+void update_ref_status(void); // Sets variables for fan speed
+int ATD_CONVERT(); // Returns the temperature value
+Fix atd_to_celsius(unsigned char atd); // Converts a sensor reading to C
+void set_fan(unsigned char zone, unsigned char level); // Fan duty for a speed level
+void report(unsigned char id, unsigned char a, unsigned char b); // Queues a message for send_reports
+#pragma CODE_SEG DEFAULT
+int key_pad(void); // Returns pressed keypad input
+void send_reports(void); // Sends the messages queued by the control law
+void handle_porth_events(void); // Reacts to debounced DIP switch transitions
+void poll_commands(void); // Executes single-character SCI commands
+void log_history(void); // Writes due history samples and new faults to EEPROM
+
+void init_ports(void); // Initializes used ports
+void init_timer(void); // Initializes the timer
+void ATD_init(void);   // Initializes the ADC (temp sensor)
+void init_zones(void); // Displays interface to let user initialize zone settings
+void init_temp(void);  // Displays interface to let user initialize temp settings
+char restore_settings(void); // Loads zone settings from EEPROM, TRUE if valid
+void apply_schedule(SysState *st); // Applies the time-of-day set point offsets
+void save_settings(void);    // Stores the keypad-entered zone settings in EEPROM
+void count_reset(void);      // Updates the warm reset counter
+
+
+/******* Main *******/
+void Control_Main(void) {
+	unsigned char temp_cur_temp;
+	SysState *st;
+	
+	if (starts == 0) { // Reset, not a main() restart
+		startup_cycles = HAL_TOF_PENDING() ? 0xFFFF : HAL_TCNT(); // First thing, TCNT still at bus clock
+		count_reset();
+	}
+	Clock_Init(); // PLL bus clock at full speed until the setup below is done
+	
+	// Re-initialize following variables, because
+	  // main() could be called as a program restart
+	State_Init(); // ref_has_started = 0, settings unknown
+	is_ref_on = is_door_open = 0;
+	f1_level = f2_level = 0;
+	log_due = 0;
+	log_ticks = 0;
+	control_ticks = 0;
+	Spsc_Reset(&atd_samples);
+	Spsc_Reset(&reports);
+	atd_sum = atd_count = atd_last = 0;
+	starts++;
+	
+	// Run all initialization functions
+	Pool_Init(); // Blocks held when main() restarted are free again
+	SCI1_Init(BAUD_9600);
+	if (starts == 1) {
+		MSG_Send(MSG_RESET, resets, startup_cycles);
+	}
+	EEPROM_Init();
+	EELog_Init();
+	init_timer();	
+	REC_Init(); // Input recording runs on the timer, from the first start on
+	RTC_Init(); // Time of day on the RTI, the profiler samples there too
+	init_ports();
+	if (!restore_settings()) { // Keypad dialog only without a valid record
+		init_zones();
+		init_temp();
+		save_settings();
+	}
+	EELog_Event(LOG_BOOT, (State_Now()->num_of_zones << 4) | (State_Now()->temp1 << 2) | (State_Now()->temp2 & 3), starts);
+	ATD_init();
+	Clock_BurstEnd(); // Setup done, idle polls run at the low clock from here on
+	
+	// Enable interrupts globally
+	HAL_ENABLE_INTERRUPTS();
+	
+	// Wait for the fridge to be turned ON
+	LCDWriteLine(2, "Turn on fridge");
+	while ((PORTH_State() & PORTH_POWER_BIT) == 0) {
+		send_reports();
+		HAL_IDLE();
+	}
+	st = State_Edit();
+	st->ref_has_started = 1;
+	State_Publish();
+	LCD_clear_disp();
+	MSG_Send(MSG_REF_STARTED, 0, 0);
+	
+	for(;;) {
+		handle_porth_events();
+		send_reports();
+		poll_commands();
+		log_history();
+		if (is_door_open == 1) {
+			HAL_BUZZER_TOGGLE(); // Toggle PT5 for Buzzer
+			HAL_LEDS_WR(HAL_LEDS_RD() ^ 0xFF);
+			MSG_Send(MSG_DOOR_OPEN, 0, 0);
+			Clock_Idle();
+			HAL_DELAY_MS(100);
+			continue;
+		}
+		
+		// Mapping DIP switches (bit 0 to 4) from 14 to 45
+		  // and setting it as local temperature
+		temp_cur_temp =	(PORTH_State() & PORTH_TEMP_MASK) + 14; // Scenario step 8
+		st = State_Edit();
+		if (temp_cur_temp < 15) {
+			st->cur_temp = 15;
+		} else {
+			st->cur_temp = temp_cur_temp;
+		}
+		apply_schedule(st);
+		State_Publish();
+		TRACE(TRACE_MARK | TRACE_LOOP, st->cur_temp);
+		
+		// Displaying status using LCD and SCI, at the low clock
+		LCD_clear_disp();
+		LCDWriteLine(1, "Cur Temp: "); // Scenario step 9
+		LCDWriteInt(st->cur_temp);
+		LCDWriteChar('F');
+		MSG_Send(MSG_CUR_TEMP, st->cur_temp, 0);
+		Clock_Idle();
+		HAL_DELAY_MS(100);
+	}
+}
+
+
+/******* Helper functions *******/
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+/* Toggle LEDs if ON */
+void update_ref_status() {
+	unsigned char ref_has_started = State_Now()->ref_has_started;
+	if (ref_has_started == 1 && is_ref_on == 1) {
+		report(MSG_REF_ON, 0, 0);
+		HAL_LEDS_WR(HAL_LEDS_RD() ^ 0xFF);
+	}
+	if (ref_has_started == 0) {
+		report(MSG_REF_OFF, 0, 0);
+		f1_level = f2_level = 0;
+		HAL_LEDS_WR(0x00);
+	}
+	is_ref_on = (PORTH_State() & PORTH_POWER_BIT) >> 6;
+	if (is_ref_on == 0) {
+		f1_level = f2_level = 0;
+	}
+}
+/* Queues a message, the control law never waits for the SCI */
+void report(unsigned char id, unsigned char a, unsigned char b) {
+	Report r;
+	r.id = id;
+	r.a = a;
+	r.b = b;
+	(void)Spsc_Put(&reports, &r); // Full ring drops it, Spsc_Dropped counts it
+}
+#pragma CODE_SEG DEFAULT
+/* Sends the messages the control law queued */
+void send_reports(void) {
+	Report r;
+	while (Spsc_Get(&reports, &r)) {
+		MSG_Send(r.id, r.a, r.b);
+	}
+}
+/* Door handling on debounced port H transitions */
+void handle_porth_events(void) {
+	PortHEvent ev;
+	while (PORTH_GetEvent(&ev)) {
+		if ((ev.changed & PORTH_DOOR_BIT) == 0) continue;
+		TRACE(TRACE_MARK | TRACE_DOOR, (ev.state & PORTH_DOOR_BIT) != 0);
+		if (ev.state & PORTH_DOOR_BIT) {
+			is_door_open = 1;
+			EELog_Event(LOG_FAULT, LOG_FAULT_DOOR, State_Now()->cur_temp);
+			LCD_clear_disp();
+			LCDWriteLine(1, "WARNING!");
+			LCDWriteLine(2, "Door is open");
+		} else {
+			is_door_open = 0;
+			HAL_BUZZER_OFF();
+			HAL_LEDS_WR(0x00);
+			HAL_SEG_OFF();
+			LCD_clear_disp();
+		}
+	}
+}
+/* Serial commands */
+void poll_commands(void) {
+	char c;
+	if (!SCI1_InStatus()) return;
+	c = SCI1_InChar();
+	TRACE(TRACE_MARK | TRACE_CMD, c);
+	Clock_Burst(); // Dumps and reports at full speed
+	switch (c) {
+		case 'L': EELog_Dump(); break; // Binary dump of the EEPROM history
+		case 'S': StackMon_Report(); break; // Stack high-water mark and ISR depths
+		case 'B': Bench_FarCopy(); break; // Far-copy cycle counts, stops the loop for a moment
+		case 'F': Bench_FixedPoint(); break; // Fixed-point cycle counts (against float with BENCH_FLOAT)
+		case 'R': REC_Dump(); break; // Binary dump of the recorded inputs (host/fridge_replay)
+		case 'T': Trace_Dump(); break; // Binary dump of the event trace (tools/trace2chrome.py)
+#ifdef PROF_SAMPLES
+		case 'P': Prof_Dump(); break; // Binary dump of the PC-sample profile (tools/prof_report.py)
+#endif
+#ifdef ISR_STATS
+		case 'I': ISRStat_Report(); break; // ISR execution time and latency
+#endif
+		case 'M': Pool_Report(); break; // Memory pool use and high-water marks
+		case 'C': Clock_Report(); break; // Clock switches, relock time, time at each speed
+		case 'K': Sched_ClockCommand(); break; // Sets the time of day, 'K' hhmmss
+		case 'W': Sched_Command(); break; // Sets a set point schedule entry (sched.h)
+		case 'D': Sched_Report(); break; // Time of day and set point schedule
+	}
+	Clock_BurstEnd();
+}
+/* Periodic history sample and EEPROM fault logging */
+void log_history(void) {
+	unsigned char status, atd;
+	while (Spsc_Get(&atd_samples, &atd)) {
+		atd_last = atd;
+		atd_sum += atd;
+		atd_count++;
+	}
+	if (EEPROM_Errors() != ee_errors) {
+		ee_errors = EEPROM_Errors();
+		Trace_Freeze(LOG_FAULT_EEPROM);
+		EELog_Event(LOG_FAULT, LOG_FAULT_EEPROM, ee_errors);
+	}
+	if (!stack_overflow_logged && StackMon_Overflow()) {
+		stack_overflow_logged = 1;
+		Trace_Freeze(LOG_FAULT_STACK);
+		MSG_Send(MSG_STACK_OVERFLOW, 0, 0);
+		EELog_Event(LOG_FAULT, LOG_FAULT_STACK, StackMon_HighWater() >> 2);
+	}
+	if (log_due == 0) return;
+	log_due = 0;
+	status = 0;
+	if (is_ref_on == 1) status |= LOG_REF_ON;
+	if (is_door_open == 1) status |= LOG_DOOR_OPEN;
+	if (atd_count != 0) atd_last = (unsigned char)(atd_sum / atd_count); // Mean over the sample period
+	atd_sum = atd_count = 0;
+	EELog_Sample(State_Now()->cur_temp, atd_last, f1_level, f2_level, status);
+}
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+/*Get ATD (temperature sensor) value */
+int ATD_CONVERT() {
+  return HAL_ATD_CONVERT(5); // Temperature sensor on channel no. 5
+}
+/* Sensor reading in C: 100 C over 51 counts, saturates at 127.99 C */
+Fix atd_to_celsius(unsigned char atd) {
+  return Fix_Ratio(atd * 100L, 51);
+}
+/* Fan duty for a speed level, reports a stopped fan starting */
+void set_fan(unsigned char zone, unsigned char level) {
+	if (level != 0 && Fan_Duty(zone) == 0) {
+		report(MSG_FAN_RUNNING, zone, 0);
+	}
+	Fan_Set(zone, fs_ON[level]);
+}
+#pragma CODE_SEG DEFAULT
+/* Pressed keypad button */
+int key_pad(void) {
+	int X;
+  for (;;) {
+		HAL_IDLE();
+		X = HAL_KEYPAD_SCAN(0xFE);
+		if (X == 0xEE) return 0x01;
+		if (X == 0xDE) return 0x04;
+		if (X == 0xBE) return 0x07;
+		if (X == 0x7E) return 0x0E;
+		X = HAL_KEYPAD_SCAN(0xFD);
+		if (X == 0xED) return 0x02;
+		if (X == 0xDD) return 0x05;
+		if (X == 0xBD) return 0x08;
+		if (X == 0x7D) return 0x00;
+		X = HAL_KEYPAD_SCAN(0xFB);
+		if (X == 0xEB) return 0x03;
+		if (X == 0xDB) return 0x06;
+		if (X == 0xBB) return 0x09;
+		if (X == 0x7B) return 0x0F;
+		X = HAL_KEYPAD_SCAN(0xF7);
+		if (X == 0xE7) return 0x0A;
+		if (X == 0xD7) return 0x0B;
+		if (X == 0xB7) return 0x0C;
+		if (X == 0x77) return 0x0D;
+	}
+}
+
+/******* Initialization functions *******/
+/* Ports initializations */
+void init_ports(void) {
+	// LCD
+	LCD_Init(); // Initialize the LCD
+	
+	// Keypad rows, LEDs, 7-seg off, buzzer
+	HAL_GPIO_INIT();
+	
+	// DIP switches, debounced by the channel 6 tick
+	PORTH_Init();
+	
+	// IRQ
+	HAL_IRQ_INIT(); // Enable and set IRQ to falling-edge trigger
+}
+/* Timer initializations */
+void init_timer(void) {
+	// General, prescaler 2^CLOCK_TIMER_PR (TSCR2 = 0x06), no overflow interrupt
+	HAL_TIMER_INIT(CLOCK_TIMER_PR);
+	
+	// Modulus down-counter, system tick every CONTROL_TICK_MS
+	HAL_MDC_INIT(CLOCK_MDC_PR, CLOCK_MS_TO_MDC(CONTROL_TICK_MS));
+	
+	// Output compare channels 0 and 7 (zone fans, fan.h), low until the first duty
+	Fan_Init();
+	
+	// Output compare channel 6 (port H sampling tick, no pin action)
+	HAL_OC_WR(6, HAL_TCNT() + PORTH_TICK_COUNTS); // First sample one tick from now
+	HAL_OC_INIT(6);
+}
+/* ADC initialization */
+void ATD_init(void) {
+  HAL_ATD_INIT(); // Power up ATD0, 8-bit resolution, prescaler of 5
+}
+/* Zones initialization */
+void init_zones() {
+	unsigned char num_of_zones;
+	LCDWriteLine(1, "Enter #Zones"); // Scenario step 1
+	num_of_zones = key_pad(); // Scenario step 2
+	while (num_of_zones != 1 && num_of_zones != 2) {
+		LCDWriteLine(1, "Either 1 or 2"); // Scenario step 3
+		num_of_zones = key_pad();
+	}
+	State_Edit()->num_of_zones = num_of_zones;
+	State_Publish();
+	LCD_clear_disp();
+	HAL_DELAY_MS(100); // Wait for 0.1 second
+	LCDWriteLine(1, "#Zones: ");
+	LCDWriteInt(num_of_zones); // Scenario step 4
+	MSG_Send(MSG_ZONES, num_of_zones, 0);
+	
+	HAL_DELAY_MS(1000); // Wait for 1 second
+	LCD_clear_disp();
+}
+/* Temperature initialization */
+void init_temp() {
+	SysState *st = State_Edit();
+	unsigned char temp1, temp2 = 0, temp1_spec = 0, temp2_spec = 0;
+	
+	// Setup zone 1 temperature level
+	LCDWriteLine(1, "Enter Z1 Temp"); // Scenario step 5
+	temp1 = key_pad(); // Scenario step 6
+	while (temp1 != 1 && temp1 != 2 && temp1 != 3) {
+		LCDWriteLine(1, "Either 1, 2 or 3");
+		temp1 = key_pad();
+	}
+	switch (temp1) { // Specifying cooling temperature of zone 1
+		case 1: temp1_spec = 20; break;
+		case 2: temp1_spec = 30; break;
+		case 3: temp1_spec = 40; break;
+	}
+	MSG_Send(MSG_ZONE_TEMP, 1, temp1_spec);
+	LCD_clear_disp();
+	HAL_DELAY_MS(100);
+	
+	// Setup zone 2 temperature level (if it exists)
+	if (st->num_of_zones == 2) {
+		LCDWriteLine(1, "Enter Z2 Temp"); // Scenario step 5
+		temp2 = key_pad(); // Scenario step 6
+		while (temp2 != 1 && temp2 != 2 && temp2 != 3) {
+			LCDWriteLine(1, "Either 1, 2 or 3");
+			temp2 = key_pad();
+		}
+		switch (temp2) { // Specifying cooling temperature of zone 2
+			case 1: temp2_spec = 20; break;
+			case 2: temp2_spec = 30; break;
+			case 3: temp2_spec = 40; break;
+		}
+		MSG_Send(MSG_ZONE_TEMP, 2, temp2_spec);
+		LCD_clear_disp();
+		HAL_DELAY_MS(100);
+	}
+	
+	st->temp1 = temp1;
+	st->temp1_spec = temp1_spec;
+	st->temp2 = temp2;
+	st->temp2_spec = temp2_spec;
+	State_Publish();
+	
+	// Display zone 1 temperature level
+	LCDWriteLine(1, "Z1 Temp: "); // Scenario step 7
+	LCDWriteInt(temp1);
+	LCDWriteChar(' ');LCDWriteChar('[');LCDWriteInt(temp1_spec);LCDWriteChar('F');LCDWriteChar(']');
+	
+	// Display zone 2 temperature level (if it exists)
+	if (st->num_of_zones == 2) {
+		LCDWriteLine(2, "Z2 Temp: "); // Scenario step 7
+		LCDWriteInt(temp2);	
+		LCDWriteChar(' ');LCDWriteChar('[');LCDWriteInt(temp2_spec);LCDWriteChar('F');LCDWriteChar(']');
+	}
+	
+	HAL_DELAY_MS(2000);
+	LCD_clear_disp();
+}
+
+
+/* Counts resets in RAM that survives them, restarts at 1 after power-on */
+void count_reset(void) {
+	if (HAL_POWER_ON_RESET() || resets_check != (unsigned short)~resets) {
+		resets = 0;
+	}
+	HAL_POWER_ON_ACK(); // Clear the power-on flag
+	resets++;
+	resets_check = ~resets;
+}
+/* Set points from the keypad levels and the schedule in force */
+void apply_schedule(SysState *st) {
+	unsigned char spec;
+	spec = Sched_Spec(1, Settings_LevelToTemp(st->temp1));
+	if (spec != st->temp1_spec) {
+		st->temp1_spec = spec;
+		MSG_Send(MSG_ZONE_TEMP, 1, spec);
+	}
+	if (st->num_of_zones == 2) {
+		spec = Sched_Spec(2, Settings_LevelToTemp(st->temp2));
+		if (spec != st->temp2_spec) {
+			st->temp2_spec = spec;
+			MSG_Send(MSG_ZONE_TEMP, 2, spec);
+		}
+	}
+}
+/* Warm boot from the EEPROM settings record */
+char restore_settings(void) {
+	Settings s;
+	SysState *st;
+	if (!Settings_Load(&s)) {
+		return 0;
+	}
+	st = State_Edit();
+	st->num_of_zones = s.num_of_zones;
+	st->temp1 = s.temp1;
+	st->temp1_spec = Settings_LevelToTemp(s.temp1);
+	if (s.num_of_zones == 2) {
+		st->temp2 = s.temp2;
+		st->temp2_spec = Settings_LevelToTemp(s.temp2);
+	}
+	State_Publish();
+	MSG_Send(MSG_SETTINGS_RESTORED, 0, 0);
+	return 1;
+}
+/* Persist the settings entered on the keypad */
+void save_settings(void) {
+	Settings s;
+	s.num_of_zones = State_Now()->num_of_zones;
+	s.temp1 = State_Now()->temp1;
+	s.temp2 = State_Now()->temp2;
+	if (!Settings_Save(&s)) {
+		MSG_Send(MSG_SETTINGS_FAILED, 0, 0);
+	}
+}
+
+
+/******* Interrupt handlers (vectors in main.c) *******/
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+/* System tick; control law: fan speeds, status LEDs, history tick, overheating.
+   Messages go through report(), the SCI would block the tick for 1 ms a byte. */
+void Control_Tick(void) {
+	signed char z1_temp_diff, z2_temp_diff; // Negative below the set point
+	unsigned char atd;
+	const SysState *st;
+	
+	HAL_MDC_ACK(); // Clear modulus counter underflow flag
+	(void)HAL_TICKS(); // Keeps the 32-bit TCNT count current, a tick is far shorter than a wrap
+	if (++control_ticks < CONTROL_PERIOD_MS / CONTROL_TICK_MS) {
+		return;
+	}
+	control_ticks = 0;
+	st = State_Now(); // Consistent snapshot, main() can't publish until this returns
+	
+	TRACE(TRACE_BEGIN | TRACE_CONTROL, 0);
+	
+	// Zone 1
+	z1_temp_diff = (signed char)(st->cur_temp - st->temp1_spec);
+	if (z1_temp_diff <= 0) {
+		f1_level = 0;	// Turn off zone 1 fan
+		report(MSG_FAN_OFF, 1, 0);
+	} else if (z1_temp_diff <= 5) {
+		f1_level = 1;	// Turn on zone 1 fan to speed level 1
+		report(MSG_FAN_LEVEL, 1, 1);
+	} else if (z1_temp_diff <= 10) {
+		f1_level = 2;	// Turn on zone 1 fan to speed level 2
+		report(MSG_FAN_LEVEL, 1, 2);
+	} else {
+		f1_level = 3;	// Turn on zone 1 fan to speed level 3
+		report(MSG_FAN_LEVEL, 1, 3);
+	}
+	
+	// Zone 2
+	z2_temp_diff = (signed char)(st->cur_temp - st->temp2_spec);
+	if (z2_temp_diff <= 0) {
+		f2_level = 0;	// Turn off zone 2 fan
+		report(MSG_FAN_OFF, 2, 0);
+	} else if (z2_temp_diff <= 5) {
+		f2_level = 1;	// Turn on zone 2 fan to speed level 1
+		report(MSG_FAN_LEVEL, 2, 1);
+	} else if (z2_temp_diff <= 10) {
+		f2_level = 2;	// Turn on zone 2 fan to speed level 2
+		report(MSG_FAN_LEVEL, 2, 2);
+	} else {
+		f2_level = 3;	// Turn on zone 2 fan to speed level 3
+		report(MSG_FAN_LEVEL, 2, 3);
+	} 
+	
+	update_ref_status();
+	set_fan(1, f1_level);
+	set_fan(2, st->num_of_zones == 2 ? f2_level : 0);
+	
+	if (++log_ticks >= log_period) {
+		log_ticks = 0;
+		log_due = 1;
+	}
+	
+	atd = ATD_CONVERT();
+	(void)Spsc_Put(&atd_samples, &atd); // Averaged into the history by log_history
+	if (atd_to_celsius(atd) > overheat_c) {
+		MSG_Send(MSG_OVERHEATING, 0, 0); // Sent here, the restart empties the queue
+		Trace_Freeze(LOG_FAULT_OVERHEAT);
+		EELog_Event(LOG_FAULT, LOG_FAULT_OVERHEAT, atd); // main() restart discards the interrupted context
+		HAL_RESTART();
+	}
+	
+	TRACE(TRACE_END | TRACE_CONTROL, (f1_level << 8) | f2_level);
+}
+/* Output compare channel 0: zone 1 fan PWM edge (no interrupt with FAN_OC7_MASTER) */
+void Control_Fan1(void) {
+	TRACE(TRACE_BEGIN | TRACE_FAN1, HAL_OC_RD(FAN_CH1));
+#ifdef FAN_OC7_MASTER
+	HAL_OC_ACK(FAN_CH1); // Not enabled, OC7 runs the period
+#else
+	Fan_Edge(1);
+#endif
+	TRACE(TRACE_END | TRACE_FAN1, HAL_OC_RD(FAN_CH1));
+}
+/* Output compare channel 7: zone 2 fan PWM edge, with FAN_OC7_MASTER the period start of all fans */
+void Control_Fan2(void) {
+	TRACE(TRACE_BEGIN | TRACE_FAN2, HAL_OC_RD(7));
+#ifdef FAN_OC7_MASTER
+	Fan_Period();
+#else
+	Fan_Edge(2);
+#endif
+	TRACE(TRACE_END | TRACE_FAN2, HAL_OC_RD(7));
+}
+/* Output compare channel 6: port H debounce tick */
+void Control_InputTick(void) {
+	TRACE(TRACE_BEGIN | TRACE_TICK, HAL_OC_RD(6));
+	HAL_OC_WR(6, HAL_OC_RD(6) + PORTH_TICK_COUNTS);
+	PORTH_Sample();
+	TRACE(TRACE_END | TRACE_TICK, HAL_OC_RD(6));
+	HAL_OC_ACK(6); // Reset channel 6 interrupt
+}
+#pragma CODE_SEG DEFAULT
+/* IRQ stop switch: stop and restart with new settings */
+void Control_Stop(void) {
+	TRACE(TRACE_MARK | TRACE_STOP, 0);
+	LCD_clear_disp();
+	LCDWriteLine(1, "Operation is");
+	LCDWriteLine(2, "stopped");
+	Settings_Invalidate(); // Ask for new zone settings on restart
+	EELog_Event(LOG_FAULT, LOG_FAULT_STOP, 0);
+	HAL_DELAY_MS(3000);	
+	update_ref_status();
+	send_reports(); // The restart empties the queue, main() is abandoned
+	HAL_RESTART();
+}
@@ -0,0 +1,44 @@
+// filename  ***************  control.h  ***************************
+// Fridge control application (control.c)
+//
+// The target's main() and interrupt vectors (main.c) are thin wrappers
+// around these, the host build (host/) registers the same handlers with
+// its register model.
+
+#define CONTROL_TICK_MS    10    // system tick, modulus down-counter period, at most 43 ms
+#define CONTROL_PERIOD_MS  100   // fan control law, a multiple of CONTROL_TICK_MS
+
+//-------------------------Control_Main-----------------------
+// Initializes everything, runs the keypad dialog and the control loop
+// Entered again through HAL_RESTART() after a stop or a fault.
+// Input: none
+// Output: never returns
+extern void Control_Main(void);
+
+//-------------------------Control_Tick-----------------------
+// Modulus down-counter underflow, every CONTROL_TICK_MS; every
+// CONTROL_PERIOD_MS the control law: fan speeds, status LEDs, history
+// tick, ATD sample. Restarts through HAL_RESTART() when overheating.
+// Input: none
+// Output: none
+//-------------------------Control_Fan1/Control_Fan2----------
+// Output compare channels 0 and 7: PWM edges of the zone 1/2 fans; with
+// FAN_OC7_MASTER channel 7 starts the period of both and 0 stays quiet (fan.h)
+// Input: none
+// Output: none
+//-------------------------Control_InputTick------------------
+// Output compare channel 6: port H debounce tick
+// Input: none
+// Output: none
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+extern void Control_Tick(void);
+extern void Control_Fan1(void);
+extern void Control_Fan2(void);
+extern void Control_InputTick(void);
+#pragma CODE_SEG DEFAULT
+
+//-------------------------Control_Stop-----------------------
+// IRQ stop switch: shows the stop, forgets the settings and restarts
+// Input: none
+// Output: never returns
+extern void Control_Stop(void);
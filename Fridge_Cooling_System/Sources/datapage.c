@@ -11,6 +11,12 @@
 #include "non_bank.sgm"
 #include "runtime.sgm"
 
+/* __FAR_COPY_BYTEWISE__ define:
+   With a single page register, _FAR_COPY_RC and _FAR_COPY hold one page for
+   the whole copy and move words whenever possible (see _FAR_COPY_CORE).
+   Define __FAR_COPY_BYTEWISE__ to get back the original loops, which switch
+   the page register twice for every byte (e.g. to compare with bench.c). */
+
 /*lint --e{957} , MISRA 8.1 REQ, these are runtime support functions and, as such, are not meant to be called in user code; they are only invoked via jumps, in compiler-generated code */
 /*lint -estring(553, __OPTION_ACTIVE__) , MISRA 19.11 REQ , __OPTION_ACTIVE__ is a built-in compiler construct to check for active compiler options */
 
@@ -770,6 +776,107 @@ done:
 #endif /* USE_SEVERAL_PAGES */
 }
 
+#if !USE_SEVERAL_PAGES && !defined(__FAR_COPY_BYTEWISE__)
+/*--------------------------- _FAR_COPY_CORE --------------------------------
+  Common copy loop of _FAR_COPY_RC and _FAR_COPY for a single page register.
+
+  Only addresses inside the page window (PPAGE_LOW_BOUND..PPAGE_HIGH_BOUND)
+  depend on the page register. If the source or the destination range lies
+  completely outside the window, or both use the same page, the page register
+  is written once for the whole copy and the data is moved with MOVW. The
+  destination is aligned to an even address first, an odd last byte is
+  copied with MOVB. Only when both ranges are paged on different pages the
+  page register is switched for every byte as before.
+
+  Arguments :
+  - offset part of the source in the X register
+  - page part of the source in the A register
+  - offset part of the dest in the Y register
+  - page part of the dest in the B register
+  - number of bytes to be copied (> 0) at 2,SP, above the return address.
+    The value is consumed by the per byte loop.
+
+  Result :
+  - memory area copied
+  - X and Y point behind the copied areas, A and B are destroyed
+  - the page register still contains the same value as before the call
+
+  stack-structure after the prologue:
+     0,SP : saved page register
+     1,SP : source page
+     2,SP : destination page
+     3,SP : return address
+     5,SP : number of bytes to be copied
+  --------------------------- _FAR_COPY_CORE ----------------------------------*/
+
+#ifdef __cplusplus
+extern "C"
+#endif
+#pragma NO_ENTRY
+#pragma NO_EXIT
+#pragma NO_FRAME
+
+static void NEAR _FAR_COPY_CORE(void) { /*lint -esym(528, _FAR_COPY_CORE) used in asm code */
+  asm {
+        PSHD                      ;/* save both pages */
+        LDAA    PAGE_ADDR         ;/* save page register */
+        PSHA
+        CPY     #PPAGE_HIGH_BOUND
+        BHI     useSrcPage        ;/* destination above the page window */
+        TFR     Y,D
+        ADDD    5,SP              ;/* destination end address */
+        CPD     #PPAGE_LOW_BOUND
+        BLS     useSrcPage        ;/* destination ends below the page window */
+        CPX     #PPAGE_HIGH_BOUND
+        BHI     useDstPage        ;/* source above the page window */
+        TFR     X,D
+        ADDD    5,SP              ;/* source end address */
+        CPD     #PPAGE_LOW_BOUND
+        BLS     useDstPage        ;/* source ends below the page window */
+        LDAB    1,SP
+        CMPB    2,SP
+        BEQ     useSrcPage        ;/* both paged, but on the same page */
+byteLoop:
+        MOVB    1,SP, PAGE_ADDR   ;/* set source page */
+        LDAA    1,X+              ;/* load value */
+        MOVB    2,SP, PAGE_ADDR   ;/* set destination page */
+        STAA    1,Y+
+        LDD     5,SP
+        SUBD    #1
+        STD     5,SP
+        BNE     byteLoop
+        BRA     done
+useDstPage:
+        LDAB    2,SP              ;/* only the destination needs its page */
+        BRA     setPage
+useSrcPage:
+        LDAB    1,SP              ;/* only the source needs its page */
+setPage:
+        STAB    PAGE_ADDR         ;/* one page register write for the whole copy */
+        TFR     Y,D
+        LSRB                      ;/* carry = destination address is odd */
+        LDD     5,SP              ;/* byte count, carry unchanged */
+        BCC     aligned
+        MOVB    1,X+, 1,Y+        ;/* align the destination */
+        SUBD    #1
+aligned:
+        LSRD                      ;/* /2 and save bit 0 in the carry */
+        BEQ     lastByte          ;/* do we copy more than 1 byte? */
+wordLoop:
+        MOVW    2,X+, 2,Y+        ;/* move a word, flags unchanged */
+        DBNE    D, wordLoop
+lastByte:
+        BCC     done              ;/* handle last byte? */
+        MOVB    1,X+, 1,Y+
+done:
+        PULA                      ;/* restore page register */
+        STAA    PAGE_ADDR
+        LEAS    2,SP              ;/* release pages */
+        RTS
+  }
+}
+#endif /* !USE_SEVERAL_PAGES && !defined(__FAR_COPY_BYTEWISE__) */
+
 /*--------------------------- _FAR_COPY_RC --------------------------------
   This runtime routine is used to access paged memory via a runtime function.
   It may also be used if the compiler  option -Cp is not used with the runtime argument.
@@ -844,6 +951,21 @@ loop:
         _SRET                     ;/* debug info only: This is the last instr of a function with a special return */
         RTS                       ;/* return */
   }
+#elif !defined(__FAR_COPY_BYTEWISE__)
+  asm {
+        PSHX                      ;/* save source offset */
+        PSHD                      ;/* save both pages */
+        LDX     4,SP              ;/* Load Return address */
+        LDD     2,X+              ;/* Load Size to copy */
+        STX     4,SP              ;/* Store adjusted return address */
+        LDX     2,SP              ;/* restore source offset */
+        STD     2,SP              ;/* size becomes the argument of _FAR_COPY_CORE */
+        PULD                      ;/* restore both pages */
+        __PIC_JSR(_FAR_COPY_CORE)
+        LEAS    2,SP              ;/* release size */
+        _SRET                     ;/* debug info only: This is the last instr of a function with a special return */
+        RTS
+  }
 #else
   asm {
         PSHD                      ;/* store page registers */
@@ -920,6 +1042,17 @@ loop:
         LEAS    10,SP             ;/* release stack */
         JMP     0,X               ;/* return */
   }
+#elif !defined(__FAR_COPY_BYTEWISE__)
+  asm {
+        PSHX                      ;/* save source offset */
+        LDX     4,SP              ;/* load counter */
+        PSHX                      ;/* pass it to _FAR_COPY_CORE */
+        LDX     2,SP              ;/* restore source offset */
+        __PIC_JSR(_FAR_COPY_CORE)
+        LEAS    4,SP              ;/* release counter copy and source offset */
+        LDX     4,SP+             ;/* release stack and load return address */
+        JMP     0,X               ;/* return */
+  }
 #else
   asm {
         PSHD                      ;/* store page registers */
@@ -0,0 +1,177 @@
+// filename  ***************  eelog.c  ****************************
+// Wear-leveled temperature and fault history in EEPROM
+// Records go through the EEPROM write-behind cache, so logging never
+// waits for the array.
+
+#include "eeprom.h"
+#include "eelog.h"
+#include "sci1.h"
+
+
+#define REC_ADDR(i)    (EE_LOG_START + (i) * EE_SECTOR_SIZE)
+#define NO_SAMPLE      0x08   // delta nibble marking an empty slot
+
+static unsigned short head;       // index of the next record to write
+static unsigned short count;      // records in the ring
+static unsigned char seq;         // sequence number of the next record
+static unsigned char sinceKey;    // records written since the last key
+static char haveKey;              // lastTemp/lastAtd are known to a decoder
+static unsigned char lastTemp, lastAtd;
+static unsigned char lastBits;    // fan levels and status of the newest sample
+static char pending;              // first half of a delta record is held
+static unsigned char pendTemp, pendAtd;
+
+
+//-------------------------EELog_Put---------------------------
+// Queues one record at the head of the ring
+// Input: record type, bytes 2 and 3
+// Output: none
+static void EELog_Put(unsigned char type, unsigned char b2, unsigned char b3) {
+  unsigned char rec[EE_SECTOR_SIZE];
+
+  rec[0] = seq;
+  rec[1] = (type << 6) | lastBits;
+  rec[2] = b2;
+  rec[3] = b3;
+  if (!EEPROM_Write(REC_ADDR(head), rec, EE_SECTOR_SIZE)) {
+    haveKey = 0;   // the delta chain is broken, restart it with a key
+    return;
+  }
+  EEPROM_Flush();
+
+  head = (head + 1 < LOG_RECORDS) ? head + 1 : 0;
+  seq = (seq < 254) ? seq + 1 : 0;
+  if (count < LOG_RECORDS) {
+    count++;
+  }
+  if (sinceKey != 0xFF) {
+    sinceKey++;
+  }
+}
+
+//-------------------------EELog_FlushPending------------------
+// Writes a half-filled delta record with its second slot empty
+// Input: none
+// Output: none
+static void EELog_FlushPending(void) {
+
+  if (pending) {
+    pending = 0;
+    EELog_Put(LOG_DELTA, (pendTemp << 4) | NO_SAMPLE, (pendAtd << 4) | NO_SAMPLE);
+  }
+}
+
+//-------------------------EELog_Init--------------------------
+// Finds the newest record and resumes logging after it
+// Input: none
+// Output: none
+void EELog_Init(void) {
+  unsigned short i, next;
+  unsigned char s, t;
+
+  head = count = 0;
+  seq = 0;
+  for (i = 0; i < LOG_RECORDS; i++) {
+    EEPROM_Read(REC_ADDR(i), &s, 1);
+    if (s == 0xFF) {
+      continue;
+    }
+    next = (i + 1 < LOG_RECORDS) ? i + 1 : 0;
+    EEPROM_Read(REC_ADDR(next), &t, 1);
+    if (t == 0xFF || t != ((s < 254) ? s + 1 : 0)) {
+      head = next;                          // i is the newest record
+      seq = (s < 254) ? s + 1 : 0;
+      count = (t == 0xFF) ? i + 1 : LOG_RECORDS;
+      break;
+    }
+  }
+
+  haveKey = 0;   // a decoder needs a fresh key after every start
+  pending = 0;
+  sinceKey = 0;
+  lastBits = 0;
+}
+
+//-------------------------EELog_Sample------------------------
+// Logs one periodic sample, as key or packed delta record
+// Input: temperature (F), raw ATD value, fan levels 0..3, status bits
+// Output: none
+void EELog_Sample(unsigned char temp, unsigned char atd,
+                  unsigned char fan1, unsigned char fan2, unsigned char status) {
+  int dt, da;
+
+  lastBits = ((fan1 & 3) << 4) | ((fan2 & 3) << 2) | (status & 3);
+
+  if (haveKey && sinceKey < LOG_KEY_EVERY) {
+    dt = (int)temp - lastTemp;
+    da = (int)atd - lastAtd;
+    if (dt >= -7 && dt <= 7 && da >= -7 && da <= 7) {
+      lastTemp = temp;
+      lastAtd = atd;
+      if (!pending) {
+        pendTemp = dt & 0x0F;
+        pendAtd = da & 0x0F;
+        pending = 1;
+      } else {
+        pending = 0;
+        EELog_Put(LOG_DELTA, (pendTemp << 4) | (dt & 0x0F), (pendAtd << 4) | (da & 0x0F));
+      }
+      return;
+    }
+  }
+
+  EELog_FlushPending();
+  sinceKey = 0;
+  haveKey = 1;
+  lastTemp = temp;
+  lastAtd = atd;
+  EELog_Put(LOG_KEY, temp, atd);
+}
+
+//-------------------------EELog_Event-------------------------
+// Logs a fault or boot record, flushing any half-filled delta record first
+// Input: LOG_FAULT or LOG_BOOT, code, argument
+// Output: none
+void EELog_Event(unsigned char type, unsigned char code, unsigned char arg) {
+
+  EELog_FlushPending();
+  EELog_Put(type, code, arg);
+}
+
+//-------------------------EELog_Count-------------------------
+// Number of records currently held in the ring
+// Input: none
+// Output: 0..LOG_RECORDS
+unsigned short EELog_Count(void) {
+  return count;
+}
+
+//-------------------------EELog_Dump--------------------------
+// Sends the whole log over SCI1 as one binary frame
+// Text output is muted while the frame is sent.
+// Input: none
+// Output: none
+void EELog_Dump(void) {
+  unsigned char rec[EE_SECTOR_SIZE];
+  unsigned short i, idx;
+  unsigned char j, sum;
+
+  SCI1_Mute(1);
+  SCI1_OutByte('E');
+  SCI1_OutByte('L');
+  SCI1_OutByte(count >> 8);
+  SCI1_OutByte(count & 0xFF);
+
+  idx = (count == LOG_RECORDS) ? head : 0;   // oldest record
+  sum = 0;
+  for (i = 0; i < count; i++) {
+    EEPROM_Read(REC_ADDR(idx), rec, EE_SECTOR_SIZE);
+    for (j = 0; j < EE_SECTOR_SIZE; j++) {
+      SCI1_OutByte(rec[j]);
+      sum += rec[j];
+    }
+    idx = (idx + 1 < LOG_RECORDS) ? idx + 1 : 0;
+  }
+  SCI1_OutByte(sum);
+  SCI1_Mute(0);
+}
@@ -0,0 +1,81 @@
+// filename  ***************  eelog.h  ****************************
+// Wear-leveled temperature and fault history in EEPROM
+//
+// The log is a ring of 4 byte records, one EEPROM sector each, so every
+// record costs exactly one sector erase and each sector is erased only
+// once per lap around the ring (760 records, 12.6 to 25 hours at one sample
+// a minute, i.e. >100 years before the 100k cycle endurance is reached).
+//
+// Record layout
+//   byte 0    sequence number 0..254 (0xFF = erased sector)
+//   byte 1    [7:6] type, [5:4] zone 1 fan level, [3:2] zone 2 fan level,
+//             [1] door open, [0] refrigerator on (as of the newest sample)
+//   byte 2,3  depend on the type:
+//     LOG_KEY    temperature (F), raw ATD sensor value
+//     LOG_DELTA  two samples packed as signed 4-bit deltas against the
+//                previous sample: byte 2 = temperature deltas (older in the
+//                high nibble), byte 3 = ATD deltas; nibble 0x8 = no sample
+//     LOG_FAULT  fault code, argument
+//     LOG_BOOT   settings (zones << 4 | temp1 << 2 | temp2),
+//                starts since reset (1 = power-on, >1 = main() restart)
+// A key record is written every LOG_KEY_EVERY records and whenever a delta
+// doesn't fit, so a decoder can start anywhere after the oldest key.
+//
+// The newest record is found at start-up as the one whose successor is
+// erased or breaks the sequence. This requires LOG_RECORDS % 255 != 0.
+
+#define LOG_RECORDS       ((EE_LOG_END + 1 - EE_LOG_START) / EE_SECTOR_SIZE)
+#define LOG_KEY_EVERY     16
+
+// Record types
+#define LOG_KEY           0
+#define LOG_DELTA         1
+#define LOG_FAULT         2
+#define LOG_BOOT          3
+
+// Fault codes
+#define LOG_FAULT_OVERHEAT  1   // argument: ATD sensor value
+#define LOG_FAULT_DOOR      2   // argument: temperature when the door opened
+#define LOG_FAULT_STOP      3   // IRQ stop button, argument unused
+#define LOG_FAULT_EEPROM    4   // argument: EEPROM error count
+#define LOG_FAULT_STACK     5   // argument: stack high-water mark / 4
+
+// Status bits
+#define LOG_REF_ON        0x01
+#define LOG_DOOR_OPEN     0x02
+
+// Bulk dump frame: 'E' 'L' count_hi count_lo records... checksum
+// Records are sent oldest first, the checksum is the 8-bit sum of all
+// record bytes.
+
+//-------------------------EELog_Init--------------------------
+// Finds the newest record and resumes logging after it
+// Input: none
+// Output: none
+extern void EELog_Init(void);
+
+//-------------------------EELog_Sample------------------------
+// Logs one periodic sample, as key or packed delta record
+// Input: temperature (F), raw ATD value, fan levels 0..3, status bits
+// Output: none
+extern void EELog_Sample(unsigned char temp, unsigned char atd,
+                         unsigned char fan1, unsigned char fan2, unsigned char status);
+
+//-------------------------EELog_Event-------------------------
+// Logs a fault or boot record, flushing any half-filled delta record first
+// Input: LOG_FAULT or LOG_BOOT, code, argument
+// Output: none
+extern void EELog_Event(unsigned char type, unsigned char code, unsigned char arg);
+
+//-------------------------EELog_Count-------------------------
+// Number of records currently held in the ring
+// Input: none
+// Output: 0..LOG_RECORDS
+extern unsigned short EELog_Count(void);
+
+//-------------------------EELog_Dump--------------------------
+// Sends the whole log over SCI1 as one binary frame
+// Text output is muted while the frame is sent.
+// Input: none
+// Output: none
+extern void EELog_Dump(void);
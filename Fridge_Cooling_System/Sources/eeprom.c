@@ -0,0 +1,330 @@
+// filename  ***************  eeprom.c  ***************************
+// On-chip EEPROM driver for the MC9S12DP256
+// Non-blocking writes through a RAM write-behind cache.
+//
+// Each dirty cache line is committed with two commands: SECTOR_MODIFY
+// (erase the sector and program its first word) followed by PROGRAM for
+// the second word. EEPROM_Service launches the next command every time
+// CCIF is raised, so the CPU never waits on the ~20 ms of array time.
+// While there is work the command-complete interrupt is enabled (CCIE),
+// when the cache is clean EEPROM_Service disables it again.
+
+#include "hal.h"             /* registers, OSCCLK (clock.h), critical sections */
+#include "eeprom.h"
+
+
+#define EE_WORD(a)   (*(volatile unsigned short *)(a))
+#define EE_BYTE(a)   (*(volatile unsigned char *)(a))
+
+// The state flags live in separate bytes so that the main loop (setting
+// dirty) and EEPROM_Service (clearing dirty, setting/clearing busy) never
+// read-modify-write a byte the other side owns.
+typedef struct _cacheLine
+{
+   unsigned short base;                 // sector address
+   unsigned char data[EE_SECTOR_SIZE];  // sector contents as they should be
+   unsigned char valid;                 // base and data hold a sector
+   volatile unsigned char dirty;        // data differs from the array, not yet started
+   volatile unsigned char busy;         // commands for this line are in flight
+} CacheLine;
+
+static CacheLine lines[EE_CACHE_LINES];
+static signed char curLine;             // line being programmed, -1 if none
+static unsigned char curStep;           // 0: SECTOR_MODIFY issued, 1: PROGRAM issued
+static volatile unsigned char errors;
+
+
+//-------------------------EEPROM_Launch----------------------
+// Starts one EEPROM command, completion is signalled by CCIF
+// Input: word aligned EEPROM address, data word, command
+// Output: none
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+static void EEPROM_Launch(unsigned short addr, unsigned short data, unsigned char cmd) {
+
+  EE_WORD(addr) = data;      // latch address and data
+  ECMD = cmd;
+  ESTAT = ESTAT_CBEIF_MASK;  // launch
+}
+#pragma CODE_SEG DEFAULT
+
+//-------------------------EEPROM_Find------------------------
+// Looks up the cache line holding a sector
+// Input: sector address
+// Output: line index, -1 if the sector is not cached
+static signed char EEPROM_Find(unsigned short base) {
+  signed char i;
+
+  for (i = 0; i < EE_CACHE_LINES; i++) {
+    if (lines[i].valid && lines[i].base == base) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+//-------------------------EEPROM_Free------------------------
+// Checks if a line may be reused without evicting a sector in [first, last]
+// Input: line index, first and last sector address of the current write
+// Output: TRUE if the line is clean and not needed by the write
+static char EEPROM_Free(unsigned char i, unsigned short first, unsigned short last) {
+
+  if (lines[i].dirty || lines[i].busy) {
+    return 0;
+  }
+  return !lines[i].valid || lines[i].base < first || lines[i].base > last;
+}
+
+//-------------------------EEPROM_Alloc-----------------------
+// Claims a free cache line and loads a sector into it
+// Input: sector address, first and last sector address of the current write
+// Output: line index, -1 if every line is dirty, in flight or in use
+static signed char EEPROM_Alloc(unsigned short base, unsigned short first, unsigned short last) {
+  signed char i;
+  unsigned char j;
+
+  for (i = 0; i < EE_CACHE_LINES; i++) {
+    if (EEPROM_Free(i, first, last)) {
+      lines[i].valid = 0;
+      lines[i].base = base;
+      for (j = 0; j < EE_SECTOR_SIZE; j++) {
+        lines[i].data[j] = EE_BYTE(base + j);
+      }
+      lines[i].valid = 1;
+      return i;
+    }
+  }
+  return -1;
+}
+
+//-------------------------EEPROM_Matches---------------------
+// Compares a cache line with the array
+// Input: line index
+// Output: TRUE if programming the line would change nothing
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+static char EEPROM_Matches(unsigned char i) {
+  unsigned char j;
+
+  for (j = 0; j < EE_SECTOR_SIZE; j++) {
+    if (lines[i].data[j] != EE_BYTE(lines[i].base + j)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+#pragma CODE_SEG DEFAULT
+
+//-------------------------EEPROM_Init------------------------
+// Sets the EEPROM clock divider, clears stale error flags and the cache
+// Input: none
+// Output: none
+void EEPROM_Init(void) {
+  unsigned char i;
+
+  if ((ECLKDIV & ECLKDIV_EDIVLD_MASK) == 0) {
+    ECLKDIV = EE_CLKDIV;   // write once after reset
+  }
+  EEPROM_Sync();         // main() restarts must not lose cached writes
+  ECNFG = 0;             // no interrupts until there is work
+  ESTAT = ESTAT_ACCERR_MASK | ESTAT_PVIOL_MASK;
+
+  for (i = 0; i < EE_CACHE_LINES; i++) {
+    lines[i].valid = lines[i].dirty = lines[i].busy = 0;
+  }
+  curLine = -1;
+  errors = 0;
+}
+
+//-------------------------EEPROM_Read------------------------
+// Copies bytes out of the EEPROM, pending cached writes included
+// Input: EEPROM address, destination buffer, number of bytes
+// Output: none
+void EEPROM_Read(unsigned short addr, void *dst, unsigned short len) {
+  unsigned char *d = (unsigned char *)dst;
+  unsigned short base;
+  signed char i;
+
+  while (len--) {
+    base = addr & ~(EE_SECTOR_SIZE - 1);
+    i = EEPROM_Find(base);
+    if (i >= 0) {
+      *d++ = lines[i].data[addr - base];
+    } else {
+      *d++ = EE_BYTE(addr);
+    }
+    addr++;
+  }
+}
+
+//-------------------------EEPROM_Write-----------------------
+// Merges bytes into the write-behind cache, never waits for the array
+// A full cache starts a flush; the write fails if no line can be freed.
+// Input: EEPROM address, source buffer, number of bytes
+// Output: TRUE if cached, FALSE on range error or cache full
+char EEPROM_Write(unsigned short addr, const void *src, unsigned short len) {
+  const unsigned char *s = (const unsigned char *)src;
+  unsigned short base, first, last;
+  unsigned char needed, avail, changed, j, ccr;
+  signed char i;
+
+  if (len == 0 || addr < EE_START || addr + len - 1 > EE_END) {
+    return 0;
+  }
+
+  // Make sure every sector touched gets a line before changing anything,
+  // a write is either cached completely or not at all. Masked up to the
+  // last merged byte: a write from an interrupt handler lands before or
+  // after this one, never in the middle.
+  HAL_CRITICAL_ENTER(ccr);
+  first = addr & ~(EE_SECTOR_SIZE - 1);
+  last = (addr + len - 1) & ~(EE_SECTOR_SIZE - 1);
+  needed = 0;
+  for (base = first; base <= last; base += EE_SECTOR_SIZE) {
+    if (EEPROM_Find(base) < 0) {
+      needed++;
+    }
+  }
+  avail = 0;
+  for (i = 0; i < EE_CACHE_LINES; i++) {
+    if (EEPROM_Free(i, first, last)) {
+      avail++;
+    }
+  }
+  if (needed > avail) {
+    HAL_CRITICAL_EXIT(ccr);
+    EEPROM_Flush();
+    return 0;
+  }
+
+  while (len) {
+    base = addr & ~(EE_SECTOR_SIZE - 1);
+    i = EEPROM_Find(base);
+    if (i < 0) {
+      i = EEPROM_Alloc(base, first, last);
+    }
+    changed = 0;
+    for (j = (unsigned char)(addr - base); j < EE_SECTOR_SIZE && len; j++, len--, addr++) {
+      if (lines[i].data[j] != *s) {
+        lines[i].data[j] = *s;
+        changed = 1;
+      }
+      s++;
+    }
+    if (changed) {
+      lines[i].dirty = 1;  // only after the data is in place
+    }
+  }
+  HAL_CRITICAL_EXIT(ccr);
+
+  if (avail == needed) {
+    EEPROM_Flush();  // cache is full of dirty lines, start draining it
+  }
+  return 1;
+}
+
+//-------------------------EEPROM_Flush-----------------------
+// Starts programming all dirty cache lines in the background
+// Input: none
+// Output: none
+void EEPROM_Flush(void) {
+  unsigned char ccr;
+
+  // CCIF is set whenever the array is idle, so enabling CCIE raises the
+  // interrupt right away and EEPROM_Service issues the first command.
+  // EEPROM_Service clears CCIE, the read-modify-write must not race it.
+  HAL_CRITICAL_ENTER(ccr);
+  if (EEPROM_Busy()) {
+    ECNFG |= ECNFG_CCIE_MASK;
+  }
+  HAL_CRITICAL_EXIT(ccr);
+}
+
+//-------------------------EEPROM_Sync------------------------
+// Flushes and waits until every cached write is in the array
+// Works with interrupts masked, e.g. before the first CLI.
+// Input: none
+// Output: none
+void EEPROM_Sync(void) {
+
+  ECNFG &= ~ECNFG_CCIE_MASK;  // service by polling, keep the ISR quiet
+  while (EEPROM_Busy()) {
+    while ((ESTAT & ESTAT_CCIF_MASK) == 0) {};
+    EEPROM_Service();
+  }
+}
+
+//-------------------------EEPROM_Busy------------------------
+// Checks for cached writes not yet programmed
+// Input: none
+// Output: TRUE while dirty or in-flight lines remain
+char EEPROM_Busy(void) {
+  unsigned char i;
+
+  for (i = 0; i < EE_CACHE_LINES; i++) {
+    if (lines[i].dirty || lines[i].busy) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+//-------------------------EEPROM_Errors----------------------
+// Number of commands rejected with ACCERR/PVIOL since init
+// Input: none
+// Output: 8-bit error count (saturates at 255)
+unsigned char EEPROM_Errors(void) {
+  return errors;
+}
+
+//-------------------------EEPROM_Service---------------------
+// Command-complete handler, called from the EEPROM interrupt
+// Input: none
+// Output: none
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+void EEPROM_Service(void) {
+  CacheLine *ln;
+  unsigned char i;
+
+  if (ESTAT & (ESTAT_ACCERR_MASK | ESTAT_PVIOL_MASK)) {
+    ESTAT = ESTAT_ACCERR_MASK | ESTAT_PVIOL_MASK;
+    if (errors != 0xFF) {
+      errors++;
+    }
+    if (curLine >= 0) {
+      lines[curLine].valid = 0;  // drop the line, don't retry forever
+      lines[curLine].busy = 0;
+      curLine = -1;
+    }
+  }
+
+  if (curLine >= 0) {
+    ln = &lines[curLine];
+    if (curStep == 0) {
+      curStep = 1;
+      if (ln->data[2] != 0xFF || ln->data[3] != 0xFF) {
+        EEPROM_Launch(ln->base + 2, ((unsigned short)ln->data[2] << 8) | ln->data[3], EE_CMD_PROGRAM);
+        return;
+      }
+    }
+    ln->busy = 0;  // sector done; a write since then left it dirty again
+    curLine = -1;
+  }
+
+  for (i = 0; i < EE_CACHE_LINES; i++) {
+    ln = &lines[i];
+    if (!ln->dirty) {
+      continue;
+    }
+    ln->dirty = 0;
+    if (EEPROM_Matches(i)) {
+      continue;  // rewritten back to what the array holds
+    }
+    ln->busy = 1;
+    curLine = i;
+    curStep = 0;
+    EEPROM_Launch(ln->base, ((unsigned short)ln->data[0] << 8) | ln->data[1], EE_CMD_SECTOR_MODIFY);
+    return;
+  }
+
+  ECNFG &= ~ECNFG_CCIE_MASK;  // cache is clean
+}
+#pragma CODE_SEG DEFAULT
@@ -0,0 +1,97 @@
+// filename  ***************  eeprom.h  ***************************
+// On-chip EEPROM driver for the MC9S12DP256
+//
+// The 4 KB EEPROM is mapped at 0x0000 (registers overlay 0x0000-0x03FF),
+// prm/Project.prm reserves 0x0400-0x0FEF for application data.
+// 0x0FF0-0x0FFF holds the EEPROM protection bytes and is never written.
+// The array is erased in 4 byte sectors and programmed in aligned words.
+//
+// Writes are non-blocking: they land in a RAM write-behind cache of
+// EE_CACHE_LINES sectors and are programmed in the background by the
+// command-complete interrupt (EEPROM_Service), one command per interrupt.
+// Reads see cached data before it reaches the array.
+//
+// EEPROM_Write and EEPROM_Flush may also be called from an interrupt
+// handler (Control_Stop does, then restarts main()): the cache update
+// runs with interrupts masked, so a write the handler cuts into is
+// either cached whole or not at all, and EEPROM_Init commits a
+// consistent cache. The other calls belong to the main loop.
+//
+// EEPROM map
+//   0x0400 - 0x0407   settings record (settings.h)
+//   0x0408 - 0x040F   reserved for settings growth
+//   0x0410 - 0x0FEF   temperature and fault ring log (eelog.h)
+
+#define EE_START          0x0400
+#define EE_END            0x0FEF
+#define EE_SECTOR_SIZE    4
+#define EE_CACHE_LINES    8     // sectors held in the write-behind cache
+
+#define EE_SETTINGS_ADDR  0x0400
+#define EE_LOG_START      0x0410
+#define EE_LOG_END        0x0FEF
+
+// The EEPROM state machine needs a 150-200 kHz clock derived from OSCCLK
+#define EE_OSC_HZ         CLOCK_OSC_HZ  // clock.h, not affected by the PLL
+#define EE_CLKDIV         ((unsigned char)(EE_OSC_HZ / 200000UL))  // 195 kHz
+
+// EEPROM commands (ECMD)
+#define EE_CMD_ERASE_VERIFY  0x05
+#define EE_CMD_PROGRAM       0x20
+#define EE_CMD_SECTOR_ERASE  0x40
+#define EE_CMD_MASS_ERASE    0x41
+#define EE_CMD_SECTOR_MODIFY 0x60
+
+//-------------------------EEPROM_Init------------------------
+// Sets the EEPROM clock divider, commits writes left over from before a
+// main() restart and clears stale error flags and the cache
+// Input: none
+// Output: none
+extern void EEPROM_Init(void);
+
+//-------------------------EEPROM_Read------------------------
+// Copies bytes out of the EEPROM, pending cached writes included
+// Input: EEPROM address, destination buffer, number of bytes
+// Output: none
+extern void EEPROM_Read(unsigned short addr, void *dst, unsigned short len);
+
+//-------------------------EEPROM_Write-----------------------
+// Merges bytes into the write-behind cache, never waits for the array
+// A full cache starts a flush; the write fails if no line can be freed.
+// Reentrant, interrupts are masked while the cache lines change.
+// Input: EEPROM address, source buffer, number of bytes
+// Output: TRUE if cached, FALSE on range error or cache full
+extern char EEPROM_Write(unsigned short addr, const void *src, unsigned short len);
+
+//-------------------------EEPROM_Flush-----------------------
+// Starts programming all dirty cache lines in the background
+// Input: none
+// Output: none
+extern void EEPROM_Flush(void);
+
+//-------------------------EEPROM_Sync------------------------
+// Flushes and waits until every cached write is in the array
+// Works with interrupts masked, e.g. before the first CLI.
+// Input: none
+// Output: none
+extern void EEPROM_Sync(void);
+
+//-------------------------EEPROM_Busy------------------------
+// Checks for cached writes not yet programmed
+// Input: none
+// Output: TRUE while dirty or in-flight lines remain
+extern char EEPROM_Busy(void);
+
+//-------------------------EEPROM_Errors----------------------
+// Number of commands rejected with ACCERR/PVIOL since init
+// Input: none
+// Output: 8-bit error count (saturates at 255)
+extern unsigned char EEPROM_Errors(void);
+
+//-------------------------EEPROM_Service---------------------
+// Command-complete handler, called from the EEPROM interrupt
+// Input: none
+// Output: none
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+extern void EEPROM_Service(void);
+#pragma CODE_SEG DEFAULT
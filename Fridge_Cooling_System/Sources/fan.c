@@ -0,0 +1,236 @@
+// filename  ***************  fan.c  ******************************
+// Fan PWM on output compare (see fan.h)
+//
+// A running channel alternates between two compares: the period start
+// with pin action SET and the pulse end with CLEAR. The action armed
+// tells Fan_Edge which of the two has just passed. With FAN_OC7_MASTER
+// the fan channels always clear, OC7 sets them through OC7M/OC7D.
+
+#include "hal.h"
+#include "fan.h"
+
+typedef char fanPeriodCheck[CLOCK_TIMER_HZ / FAN_PWM_HZ < 0x8000UL &&
+                            FAN_PERIOD > 2 * FAN_LEAD_TICKS ? 1 : -1];
+
+typedef struct _fan {
+  unsigned char ch;        // timer channel, pin PTch
+  unsigned char run;       // the compare interrupt drives the pin
+  unsigned short want;     // high time from the next period on (Fan_Set)
+  unsigned short high;     // high time of the current period
+  unsigned short start;    // TCNT of the current period start
+} Fan;
+
+static Fan fans[FAN_ZONES] = { { FAN_CH1 }, { FAN_CH2 } };
+
+#ifdef FAN_OC7_MASTER
+static unsigned char run;      // the OC7 interrupt is on
+static unsigned short start;   // TCNT of the current period start, for all fans
+#endif
+
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+static char late(unsigned char ch, unsigned short next);
+#ifdef FAN_OC7_MASTER
+static char latch(void);
+static void restart(void);
+#else
+static void step(Fan *f);
+#endif
+#pragma CODE_SEG DEFAULT
+
+//-------------------------Fan_Init---------------------------
+// Both fan pins low, duty 0, channel interrupts off
+// Input: none
+// Output: none
+void Fan_Init(void) {
+  unsigned char i, mask = 0;
+
+  for (i = 0; i < FAN_ZONES; i++) {
+    fans[i].run = 0;
+    fans[i].want = fans[i].high = 0;
+    HAL_OC_ACTION(fans[i].ch, HAL_OC_CLEAR);
+    HAL_OC_INIT(fans[i].ch);
+    HAL_OC_IRQ_OFF(fans[i].ch);
+    HAL_OC_FORCE(fans[i].ch);   // low now, not at the next compare
+    mask |= 1 << fans[i].ch;
+  }
+#ifdef FAN_OC7_MASTER
+  run = 0;
+  HAL_OC7_INIT(mask);           // OC7D 0: the master compare keeps them low
+  HAL_OC_ACTION(FAN_MASTER, HAL_OC_NONE);
+  HAL_OC_INIT(FAN_MASTER);
+  HAL_OC_IRQ_OFF(FAN_MASTER);
+#else
+  (void)mask;
+#endif
+}
+
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+//-------------------------Fan_Set----------------------------
+// Duty for a zone fan from the next period on; called with interrupts
+// masked (system tick)
+// Input: zone 1..FAN_ZONES, high time 0..FAN_PERIOD ticks (more is 100 %)
+// Output: none
+void Fan_Set(unsigned char zone, unsigned short high) {
+  Fan *f = &fans[zone - 1];
+
+  if (high > FAN_PERIOD) {
+    high = FAN_PERIOD;
+  }
+  f->want = high;
+#ifdef FAN_OC7_MASTER
+  if (!run && high != f->high) {
+    restart();   // else Fan_Period takes it at the next period start
+  }
+#else
+  if (f->run) {
+    return;   // step takes it at the end of the pulse
+  }
+  if (HAL_OC_ACTION_RD(f->ch) == HAL_OC_SET) {
+    if (high == FAN_PERIOD) {
+      return;
+    }
+    f->start = HAL_TCNT();   // held high so far: a period starting now
+    f->high = high;
+  } else {
+    if (high == 0) {
+      return;
+    }
+    f->start = HAL_TCNT() + FAN_LEAD_TICKS - FAN_PERIOD;   // held low: as if a pulse just ended
+  }
+  f->run = 1;
+  HAL_OC_ACK(f->ch);
+  HAL_OC_IRQ_ON(f->ch);
+  step(f);
+#endif
+}
+
+//-------------------------Fan_Duty---------------------------
+// Input: zone 1..FAN_ZONES
+// Output: duty last set, ticks of FAN_PERIOD
+unsigned short Fan_Duty(unsigned char zone) {
+  return fans[zone - 1].want;
+}
+
+// Arms the next compare; TRUE when TCNT is already past it, the pin action
+// is then forced now and the compare will not interrupt
+static char late(unsigned char ch, unsigned short next) {
+  HAL_OC_WR(ch, next);
+  if ((short)(HAL_TCNT() - next) < 0) {
+    return 0;
+  }
+  HAL_OC_FORCE(ch);
+  HAL_OC_ACK(ch);
+  return 1;
+}
+
+#ifdef FAN_OC7_MASTER
+//-------------------------Fan_Period-------------------------
+// OC7 compare interrupt at the period start of every fan: acknowledges
+// it, schedules the pulse ends and the next period start
+// Input: none
+// Output: none
+void Fan_Period(void) {
+  Fan *f;
+  unsigned short next;   // next period start
+  unsigned char i, held = 1;
+
+  HAL_OC_ACK(FAN_MASTER);
+  next = start + FAN_PERIOD;
+  if ((short)(HAL_TCNT() - next) >= 0) {
+    next = HAL_TCNT() + FAN_LEAD_TICKS;   // a whole period late: new phase
+  }
+  HAL_OC_WR(FAN_MASTER, next);
+  for (i = 0; i < FAN_ZONES; i++) {
+    f = &fans[i];
+    if (f->high == 0 || f->high == FAN_PERIOD) {
+      HAL_OC_WR(f->ch, next);   // with the master, which has priority: no edge
+    } else {
+      held = 0;
+      (void)late(f->ch, start + f->high);   // pulse end
+    }
+  }
+  start = next;
+  if (latch() && held) {
+    run = 0;   // OC7D holds every pin from the next start on
+    HAL_OC_IRQ_OFF(FAN_MASTER);
+  }
+}
+
+// Duties wanted become those of the next period: OC7D sets the pins of
+// the fans that run then. TRUE when every fan is at 0 or 100 %.
+static char latch(void) {
+  Fan *f;
+  unsigned char i, data = 0, held = 1;
+
+  for (i = 0; i < FAN_ZONES; i++) {
+    f = &fans[i];
+    f->high = f->want;
+    if (f->high != 0) {
+      data |= 1 << f->ch;
+      if (f->high != FAN_PERIOD) {
+        held = 0;
+      }
+    }
+  }
+  HAL_OC7_DATA(data);
+  return held;
+}
+
+// Starts the stopped master shortly, with the duties wanted now
+static void restart(void) {
+  unsigned char i;
+
+  start = HAL_TCNT() + FAN_LEAD_TICKS;
+  for (i = 0; i < FAN_ZONES; i++) {
+    HAL_OC_WR(fans[i].ch, start);   // with the master: no stray edge
+  }
+  (void)latch();
+  HAL_OC_WR(FAN_MASTER, start);
+  HAL_OC_ACK(FAN_MASTER);
+  HAL_OC_IRQ_ON(FAN_MASTER);
+  run = 1;
+}
+#else
+//-------------------------Fan_Edge---------------------------
+// Compare interrupt of a fan channel: acknowledges it, schedules the
+// next edge
+// Input: zone 1..FAN_ZONES
+// Output: none
+void Fan_Edge(unsigned char zone) {
+  Fan *f = &fans[zone - 1];
+
+  HAL_OC_ACK(f->ch);
+  step(f);
+}
+
+// Schedules the edge after the one just passed, until one lies ahead or
+// the pin is held at 0 or 100 %
+static void step(Fan *f) {
+  unsigned short next;
+
+  for (;;) {
+    if (HAL_OC_ACTION_RD(f->ch) == HAL_OC_SET) {   // period start, pin high
+      if (f->high == FAN_PERIOD) {
+        break;
+      }
+      next = f->start + f->high;
+      HAL_OC_ACTION(f->ch, HAL_OC_CLEAR);
+    } else {                                       // pulse end, pin low
+      f->high = f->want;
+      if (f->high == 0) {
+        break;
+      }
+      f->start += FAN_PERIOD;
+      next = f->start;
+      HAL_OC_ACTION(f->ch, HAL_OC_SET);
+    }
+    if (!late(f->ch, next)) {
+      return;
+    }
+  }
+  f->run = 0;   // the armed action keeps the pin where it is
+  HAL_OC_IRQ_OFF(f->ch);
+  HAL_OC_ACK(f->ch);
+}
+#endif
+#pragma CODE_SEG DEFAULT
@@ -0,0 +1,72 @@
+// filename  ***************  fan.h  ******************************
+// Fan PWM on output compare
+//
+// Each zone fan runs at a fixed FAN_PERIOD with its high time in timer
+// ticks, so the duty resolution is one tick. The compare interrupt sets
+// the pin at the period start and clears it after the high time; a new
+// duty from Fan_Set is taken at the end of a pulse, so it starts with
+// the next period and no pulse comes out cut short or doubled. A duty of
+// 0 or FAN_PERIOD holds the pin and turns the channel interrupt off, it
+// comes back on when the duty moves away from the limit. An edge the
+// interrupt latency let pass is forced late with CFORC instead of
+// waiting a whole counter wrap.
+//
+// Built with FAN_OC7_MASTER, OC7 is the period master instead: through
+// OC7M/OC7D its compare sets every fan pin at the period start, and each
+// fan channel only clears its pin, without an interrupt. The one OC7
+// interrupt per period schedules all the clears and latches the duties
+// for the next period (OC7D 0 for a stopped fan; a full duty clears on
+// the next period start, where OC7 has priority). With every fan at 0 or
+// 100 % it stops too. OC7 can't drive its own pin from this, so the
+// zone 2 fan moves from PT7 to PT1; more zones take more channels, not
+// more interrupts.
+
+#define FAN_ZONES       2
+#define FAN_PWM_HZ      100UL
+#define FAN_PERIOD      ((unsigned short)(CLOCK_TIMER_HZ / FAN_PWM_HZ))   // 3750 ticks, 10 ms
+#define FAN_LEAD_TICKS  CLOCK_US_TO_TICKS(50)   // first edge after the interrupt comes back on
+#define FAN_DUTY_PM(pm) ((unsigned short)((unsigned long)FAN_PERIOD * (pm) / 1000))  // per mille to ticks
+
+#define FAN_CH1         0   // zone 1 fan on PT0 (OC0)
+#ifdef FAN_OC7_MASTER
+#define FAN_CH2         1   // zone 2 fan on PT1 (OC1)
+#define FAN_MASTER      7   // period master (OC7)
+#else
+#define FAN_CH2         7   // zone 2 fan on PT7 (OC7)
+#endif
+
+//-------------------------Fan_Init---------------------------
+// Both fan pins low, duty 0, channel interrupts off
+// Input: none
+// Output: none
+extern void Fan_Init(void);
+
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+//-------------------------Fan_Set----------------------------
+// Duty for a zone fan from the next period on; called with interrupts
+// masked (system tick)
+// Input: zone 1..FAN_ZONES, high time 0..FAN_PERIOD ticks (more is 100 %)
+// Output: none
+extern void Fan_Set(unsigned char zone, unsigned short high);
+
+//-------------------------Fan_Duty---------------------------
+// Input: zone 1..FAN_ZONES
+// Output: duty last set, ticks of FAN_PERIOD
+extern unsigned short Fan_Duty(unsigned char zone);
+
+#ifdef FAN_OC7_MASTER
+//-------------------------Fan_Period-------------------------
+// OC7 compare interrupt at the period start of every fan: acknowledges
+// it, schedules the pulse ends and the next period start
+// Input: none
+// Output: none
+extern void Fan_Period(void);
+#else
+//-------------------------Fan_Edge---------------------------
+// Compare interrupt of a fan channel: acknowledges it, schedules the
+// next edge
+// Input: zone 1..FAN_ZONES
+// Output: none
+extern void Fan_Edge(unsigned char zone);
+#endif
+#pragma CODE_SEG DEFAULT
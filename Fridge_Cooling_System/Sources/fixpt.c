@@ -0,0 +1,120 @@
+// filename  ***************  fixpt.c  ****************************
+// Q8.8 fixed-point arithmetic (see fixpt.h)
+
+#include "fixpt.h"
+
+static const unsigned short pow10[4] = { 1, 10, 100, 1000 };
+
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+// Clamps a wider intermediate into the Fix range
+static Fix saturate(long v) {
+  if (v > FIX_MAX) {
+    return FIX_MAX;
+  }
+  if (v < FIX_MIN) {
+    return FIX_MIN;
+  }
+  return (Fix)v;
+}
+
+// Rounds x / d to nearest, halves away from zero, d != 0
+static long divRound(long x, long d) {
+  if (d < 0) {
+    x = -x;
+    d = -d;
+  }
+  if (x < 0) {
+    return -((-x + d / 2) / d);
+  }
+  return (x + d / 2) / d;
+}
+
+//-------------------------Fix_Add----------------------------
+// Saturating sum
+// Input: a, b
+// Output: a + b
+Fix Fix_Add(Fix a, Fix b) {
+  return saturate((long)a + b);
+}
+
+//-------------------------Fix_Sub----------------------------
+// Saturating difference
+// Input: a, b
+// Output: a - b
+Fix Fix_Sub(Fix a, Fix b) {
+  return saturate((long)a - b);
+}
+
+//-------------------------Fix_Mul----------------------------
+// Saturating product, rounded
+// Input: a, b
+// Output: a * b
+Fix Fix_Mul(Fix a, Fix b) {
+  return saturate(divRound((long)a * b, FIX_ONE));
+}
+
+//-------------------------Fix_Div----------------------------
+// Saturating quotient, rounded; division by 0 gives FIX_MAX or FIX_MIN
+// Input: a, b
+// Output: a / b
+Fix Fix_Div(Fix a, Fix b) {
+  if (b == 0) {
+    return a < 0 ? FIX_MIN : FIX_MAX;
+  }
+  return saturate(divRound((long)a * FIX_ONE, b));
+}
+
+//-------------------------Fix_Ratio--------------------------
+// Scaled divide of two integers, e.g. a sensor reading times its full
+// scale over its resolution, saturating and rounded
+// Input: numerator, denominator > 0
+// Output: num / den
+Fix Fix_Ratio(long num, long den) {
+  if (num > 128L * den) {
+    return FIX_MAX;   // also keeps num * FIX_ONE within a long
+  }
+  if (num < -128L * den) {
+    return FIX_MIN;
+  }
+  return saturate(divRound(num * FIX_ONE, den));
+}
+
+//-------------------------Fix_ToInt--------------------------
+// Nearest integer, halves away from zero
+// Input: value
+// Output: integer -128..128
+int Fix_ToInt(Fix a) {
+  return (int)divRound(a, FIX_ONE);
+}
+#pragma CODE_SEG DEFAULT
+
+//-------------------------Fix_Format-------------------------
+// Decimal text with a fixed number of decimals, e.g. "-12.50"
+// Input: buffer (at least 10 chars), value, decimals 0..3
+// Output: length of the text, buffer is NUL terminated
+unsigned char Fix_Format(char *buf, Fix a, unsigned char decimals) {
+  char digits[8];
+  unsigned long scaled;
+  unsigned char n = 0, i = 0;
+
+  if (decimals > 3) {
+    decimals = 3;
+  }
+  scaled = (unsigned long)(a < 0 ? -(long)a : a);
+  scaled = (scaled * pow10[decimals] + FIX_ONE / 2) / FIX_ONE;   // |value| * 10^decimals
+  if (a < 0 && scaled != 0) {
+    buf[n++] = '-';   // no "-0.00"
+  }
+  do {
+    digits[i++] = (char)('0' + scaled % 10);
+    scaled /= 10;
+  } while (scaled != 0 || i <= decimals);   // at least one digit before the point
+  while (i > 0) {
+    if (i == decimals && decimals > 0) {
+      buf[n++] = '.';
+    }
+    buf[n++] = digits[--i];
+  }
+  buf[n] = 0;
+  return n;
+}
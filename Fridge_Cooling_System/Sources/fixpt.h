@@ -0,0 +1,70 @@
+// filename  ***************  fixpt.h  ****************************
+// Q8.8 fixed-point arithmetic
+//
+// A Fix is a signed 16-bit value in 1/256 units: -128.0 to +127.996,
+// enough for temperatures in F or C with a resolution of 0.004. All
+// operations saturate at the ends of the range instead of wrapping and
+// round to nearest, so no soft-float runtime is needed anywhere.
+// lcd.h includes it too, hence the guard.
+
+#ifndef FIXPT_H
+#define FIXPT_H
+
+typedef short Fix;
+
+#define FIX_FRAC_BITS   8
+#define FIX_ONE         256
+#define FIX_MAX         ((Fix)0x7FFF)
+#define FIX_MIN         ((Fix)-0x8000)
+
+// Integer constant as a Fix, i must be within -128..127
+#define FIX_INT(i)      ((Fix)((i) * FIX_ONE))
+
+// The arithmetic is near, the system tick ISR uses it
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+
+//-------------------------Fix_Add----------------------------
+// Saturating sum
+// Input: a, b
+// Output: a + b
+extern Fix Fix_Add(Fix a, Fix b);
+
+//-------------------------Fix_Sub----------------------------
+// Saturating difference
+// Input: a, b
+// Output: a - b
+extern Fix Fix_Sub(Fix a, Fix b);
+
+//-------------------------Fix_Mul----------------------------
+// Saturating product, rounded
+// Input: a, b
+// Output: a * b
+extern Fix Fix_Mul(Fix a, Fix b);
+
+//-------------------------Fix_Div----------------------------
+// Saturating quotient, rounded; division by 0 gives FIX_MAX or FIX_MIN
+// Input: a, b
+// Output: a / b
+extern Fix Fix_Div(Fix a, Fix b);
+
+//-------------------------Fix_Ratio--------------------------
+// Scaled divide of two integers, e.g. a sensor reading times its full
+// scale over its resolution, saturating and rounded
+// Input: numerator, denominator > 0
+// Output: num / den
+extern Fix Fix_Ratio(long num, long den);
+
+//-------------------------Fix_ToInt--------------------------
+// Nearest integer, halves away from zero
+// Input: value
+// Output: integer -128..128
+extern int Fix_ToInt(Fix a);
+#pragma CODE_SEG DEFAULT
+
+//-------------------------Fix_Format-------------------------
+// Decimal text with a fixed number of decimals, e.g. "-12.50"
+// Input: buffer (at least 10 chars), value, decimals 0..3
+// Output: length of the text, buffer is NUL terminated
+extern unsigned char Fix_Format(char *buf, Fix a, unsigned char decimals);
+
+#endif
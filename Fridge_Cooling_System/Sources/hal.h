@@ -0,0 +1,92 @@
+// filename  ***************  hal.h  ******************************
+// Hardware abstraction for the application code
+//
+// control.c, lcd.c, sci1.c and porth.c reach the MC9S12DP256 only through
+// the calls below, so the same sources also build with GCC on a host.
+// HAL_HOST selects the host implementation (host/hal_host.h, an
+// in-memory register model), otherwise hal_hcs12.h maps every call
+// straight onto the registers.
+//
+// GPIO
+//   HAL_GPIO_INIT()           port directions: keypad, LEDs, buzzer, 7-seg off
+//   HAL_LEDS_RD(), HAL_LEDS_WR(v)        port B LEDs
+//   HAL_BUZZER_TOGGLE(), HAL_BUZZER_OFF()  PT5
+//   HAL_SEG_OFF()             7-segment common cathodes off
+//   HAL_DIP_INIT(), HAL_DIP_RD()         port H DIP switches, no edge interrupts
+//   HAL_KEYPAD_SCAN(row)      drives a keypad row (PA0..3 low = active),
+//                             returns port A with the column inputs
+//   HAL_IRQ_INIT()            IRQ pin, falling edge
+// Timer / output compare (ch 0..7)
+//   HAL_TIMER_INIT(ctl2)      enables TCNT, TSCR2 = ctl2 (prescaler, TOI)
+//   HAL_TCNT()                free-running counter
+//   HAL_TOF_PENDING(), HAL_TOF_ACK()
+//   HAL_MDC_INIT(pr, count)   modulus down-counter: periodic underflow interrupt
+//                             every count clocks of bus / MCPR pr
+//   HAL_MDC_ACK()             clears the underflow flag
+//   HAL_OC_INIT(ch)           output compare with interrupt, flag cleared
+//   HAL_OC_RD(ch), HAL_OC_WR(ch, t)      compare register
+//   HAL_OC_ACTION(ch, a)      pin action HAL_OC_NONE/TOGGLE/CLEAR/SET
+//   HAL_OC_ACTION_RD(ch)      pin action currently set
+//   HAL_OC_ACK(ch)            clears the channel flag
+//   HAL_OC_IRQ_ON(ch), HAL_OC_IRQ_OFF(ch)   channel interrupt enable, the
+//                             compare and its pin action go on without it
+//   HAL_OC_FORCE(ch)          pin action now (CFORC), the flag stays clear
+//   HAL_OC7_INIT(mask)        OC7 compares also drive the pins in mask (OC7M),
+//                             OC7D cleared; OC7 wins over a channel's own
+//                             compare in the same cycle
+//   HAL_OC7_DATA(d)           levels OC7 puts on those pins (OC7D)
+// Real-time interrupt
+//   HAL_RTI_INIT(ctl)         RTICTL = ctl, flag cleared, interrupt on
+//   HAL_RTI_ACK()             clears the RTI flag
+//   HAL_PPAGE()               program page of the paged flash window
+// ATD
+//   HAL_ATD_INIT()            powers up ATD0, 8-bit results
+//   HAL_ATD_CONVERT(ch)       one conversion, waits for the result
+// SCI1
+//   HAL_SCI_INIT(bdh, bdl)    baud divisor, 8N1, TX and RX enabled, RX interrupt on
+//   HAL_SCI_RX_READY(), HAL_SCI_RX()   receiver, read from the RX interrupt only
+//   HAL_SCI_TX_READY(), HAL_SCI_TX(c)
+//   HAL_SCI_BAUD(bdh, bdl)    baud divisor only, after a bus clock change
+//   HAL_SCI_TX_IDLE()         TRUE once the last byte has left the shifter
+// LCD bus (port K: RS, E and four data lines)
+//   HAL_LCD_INIT(), HAL_LCD_RD(), HAL_LCD_WR(v)
+// System
+//   HAL_ENABLE_INTERRUPTS(), HAL_DISABLE_INTERRUPTS()
+//   HAL_IDLE()                called in every busy-wait loop, lowers the bus
+//                             clock unless a Clock_Burst is open (clock.h)
+//   HAL_DELAY_MS(ms)          calibrated busy delay
+//   HAL_RESTART()             restarts the application from main()
+//   HAL_POWER_ON_RESET()      TRUE once after power-on, HAL_POWER_ON_ACK() clears it
+//   HAL_CLOCK_INIT()          bus clock from the PLL as set in clock.h, waits for
+//                             lock; nothing to do when it already runs on the PLL
+//   HAL_CLOCK_SELECT(mode)    relocks for CLOCK_FULL or CLOCK_LOW, keeps TCNT at
+//                             CLOCK_TIMER_HZ; returns the relock time (clock.c)
+//   HAL_TICKS()               TCNT extended to 32 bits; on the target it must be
+//                             read at least once per counter wrap, HAL_DELAY_MS
+//                             and every recorded input read do that
+//   HAL_CRITICAL_ENTER(ccr), HAL_CRITICAL_EXIT(ccr)
+//                             masks interrupts, then restores the state saved
+//                             in ccr (a local unsigned char)
+//
+// The input reads (DIP switches, keypad, ATD, SCI receive) also go through
+// the input recorder, see rec.h.
+
+#define HAL_OC_NONE     0
+#define HAL_OC_TOGGLE   1
+#define HAL_OC_CLEAR    2
+#define HAL_OC_SET      3
+
+#include "clock.h"           /* bus clock and the constants derived from it */
+
+#ifdef HAL_HOST
+#include "hal_host.h"
+#else
+#include "hal_hcs12.h"
+#endif
+
+#include "rec.h"
+
+#define HAL_DIP_RD()          REC_IN(REC_DIP, HAL_DIP_RAW())
+#define HAL_KEYPAD_SCAN(row)  REC_IN(REC_KEYPAD + REC_ROW(row), HAL_KEYPAD_RAW(row))
+#define HAL_ATD_CONVERT(ch)   REC_IN(REC_ATD + (ch), HAL_ATD_RAW(ch))
+#define HAL_SCI_RX()          REC_IN(REC_SCI_RX, HAL_SCI_RX_RAW())
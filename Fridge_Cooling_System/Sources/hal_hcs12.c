@@ -0,0 +1,128 @@
+// filename  ***************  hal_hcs12.c  ************************
+// Hardware abstraction, MC9S12DP256 implementation (see hal.h)
+// The calls that wait; everything else is a macro in hal_hcs12.h.
+
+#include "hal.h"
+
+static unsigned long ticks;     // HAL_Ticks count
+static unsigned short lastTcnt; // TCNT at the previous HAL_Ticks call
+static unsigned short delayLoops; // HAL_DelayMs inner loop passes per ms, per bus clock
+
+//-------------------------HAL_DelayMs-------------------------
+// Busy delay, calibrated for the current bus clock (clock.h)
+// Keeps HAL_Ticks current, a delay may be longer than a counter wrap.
+// Input: milliseconds
+// Output: none
+void HAL_DelayMs(unsigned int ms) {
+  unsigned int i;
+
+  while (ms--) {
+    (void)HAL_Ticks();
+    for (i = 0; i < delayLoops; i++) {
+      asm("NOP\n");
+    }
+  }
+}
+
+// Runs the bus from OSCCLK, restarts the PLL with new dividers and
+// selects it again once locked
+// Input: REFDV value
+// Output: TCNT ticks spent waiting for lock
+static unsigned short relock(unsigned char refdv) {
+  unsigned short t0;
+
+  CLKSEL &= ~CLKSEL_PLLSEL_MASK;   // bus = OSCCLK / 2
+  PLLCTL &= ~PLLCTL_PLLON_MASK;    // clears LOCK, the wait below is for the new dividers
+  SYNR = CLOCK_SYNR;               // only written while the PLL is deselected
+  REFDV = refdv;
+  PLLCTL |= PLLCTL_PLLON_MASK;
+  t0 = TCNT;
+  while ((CRGFLG & CRGFLG_LOCK_MASK) == 0) {};
+  t0 = TCNT - t0;
+  CLKSEL |= CLKSEL_PLLSEL_MASK;    // bus = PLLCLK / 2
+  return t0;
+}
+
+//-------------------------HAL_ClockInit-----------------------
+// Switches the bus clock to the PLL (CLOCK_SYNR, CLOCK_REFDV), waits for
+// lock; returns at once when the PLL already runs at full speed
+// Input: none
+// Output: none
+void HAL_ClockInit(void) {
+
+  delayLoops = CLOCK_DELAY_LOOPS;
+  if ((CLKSEL & CLKSEL_PLLSEL_MASK) && REFDV == CLOCK_REFDV) {
+    return;                        // main() restart, SYNR/REFDV are locked in
+  }
+  (void)relock(CLOCK_REFDV);       // reset, or a main() restart at CLOCK_LOW
+}
+
+//-------------------------HAL_ClockSelect---------------------
+// Relocks the PLL for CLOCK_FULL or CLOCK_LOW and sets the timer, modulus
+// counter and ATD prescalers and the delay loop to match; call with interrupts masked
+// and the SCI transmitter idle, then set the baud divisor
+// Input: CLOCK_FULL or CLOCK_LOW
+// Output: relock time in TCNT ticks of CLOCK_OSC_TICK_US
+unsigned short HAL_ClockSelect(unsigned char mode) {
+  unsigned short t;
+
+  TSCR2 = (TSCR2 & ~0x07) | CLOCK_OSC_TIMER_PR;
+  if (mode == CLOCK_LOW) {
+    t = relock(CLOCK_LOW_REFDV);
+    TSCR2 = (TSCR2 & ~0x07) | CLOCK_LOW_TIMER_PR;
+    MCCTL = (MCCTL & ~0x03) | CLOCK_LOW_MDC_PR;
+    ATD0CTL4 = 0x80 | CLOCK_ATD_PRS_AT(CLOCK_LOW_HZ);
+    delayLoops = CLOCK_DELAY_LOOPS_AT(CLOCK_LOW_HZ);
+  } else {
+    t = relock(CLOCK_REFDV);
+    TSCR2 = (TSCR2 & ~0x07) | CLOCK_TIMER_PR;
+    MCCTL = (MCCTL & ~0x03) | CLOCK_MDC_PR;
+    ATD0CTL4 = 0x80 | CLOCK_ATD_PRS;
+    delayLoops = CLOCK_DELAY_LOOPS;
+  }
+  return t;
+}
+
+//-------------------------HAL_AtdConvert----------------------
+// One ATD0 conversion, right justified
+// Input: channel 0..7
+// Output: 8-bit result
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+unsigned char HAL_AtdConvert(unsigned char ch) {
+
+  ATD0CTL5 = 0x80 | ch;                   // right justified, single channel
+  while ((ATD0STAT0 & ATD0STAT0_SCF_MASK) == 0) {};
+  return (unsigned char)ATD0DR0;
+}
+
+//-------------------------HAL_Ticks---------------------------
+// Adds the TCNT ticks since the previous call to a 32-bit count
+// Input: none
+// Output: ticks since the timer started
+unsigned long HAL_Ticks(void) {
+  unsigned long now;
+  unsigned short tcnt;
+  unsigned char ccr;
+
+  HAL_CRITICAL_ENTER(ccr);
+  tcnt = TCNT;
+  ticks += (unsigned short)(tcnt - lastTcnt);
+  lastTcnt = tcnt;
+  now = ticks;
+  HAL_CRITICAL_EXIT(ccr);
+  return now;
+}
+#pragma CODE_SEG DEFAULT
+
+//-------------------------HAL_TicksSkip-----------------------
+// Drops the TCNT counts since the previous HAL_Ticks call, for a
+// stretch when TCNT ran at another prescaler (bench.c)
+// Input: none
+// Output: none
+void HAL_TicksSkip(void) {
+  unsigned char ccr;
+
+  HAL_CRITICAL_ENTER(ccr);
+  lastTcnt = TCNT;
+  HAL_CRITICAL_EXIT(ccr);
+}
@@ -0,0 +1,125 @@
+// filename  ***************  hal_hcs12.h  ************************
+// Hardware abstraction, MC9S12DP256 implementation (see hal.h)
+// Everything except the waiting calls is a plain register access.
+
+#include <hidef.h>
+#include "derivative.h"      /* derivative-specific definitions */
+
+// GPIO
+#define HAL_GPIO_INIT()       (DDRA = 0x0F, PUCR = 0x01, DDRB = 0xFF, DDRJ = 0xFF, \
+                               PTJ = 0x00, PTP = 0x0F, DDRT = 0xFF)
+#define HAL_LEDS_RD()         (PORTB)
+#define HAL_LEDS_WR(v)        (PORTB = (v))
+#define HAL_BUZZER_TOGGLE()   (PTT ^= 0x20)
+#define HAL_BUZZER_OFF()      (PTT &= ~0x20)
+#define HAL_SEG_OFF()         (PTP = 0x0F)
+#define HAL_DIP_INIT()        (DDRH = 0x00, PIEH = 0x00, PIFH = 0xFF)
+#define HAL_DIP_RAW()         (PTH)
+#define HAL_KEYPAD_RAW(row)   (PORTA = (row), PORTA)
+#define HAL_IRQ_INIT()        (INTCR = 0xC0)
+
+// Timer / output compare
+#define HAL_TIMER_INIT(ctl2)  (TSCR1 = TSCR1_TEN_MASK, TSCR2 = (ctl2), TFLG2 = TFLG2_TOF_MASK)
+#define HAL_TCNT()            (TCNT)
+#define HAL_TOF_PENDING()     (TFLG2 & TFLG2_TOF_MASK)
+#define HAL_TOF_ACK()         (TFLG2 = TFLG2_TOF_MASK)
+#define HAL_MDC_INIT(pr, count) (MCCTL = MCCTL_MCZI_MASK | MCCTL_MODMC_MASK | MCCTL_MCEN_MASK | (pr), MCCNT = (count), MCFLG = MCFLG_MCZF_MASK)
+#define HAL_MDC_ACK()         (MCFLG = MCFLG_MCZF_MASK)
+#define HAL_OC_INIT(ch)       (TFLG1 = 1 << (ch), TIE |= 1 << (ch), TIOS |= 1 << (ch))
+// TC0..TC7 are consecutive words; a constant channel folds to one address
+#define HAL_OC_RD(ch)         ((&TC0)[ch])
+#define HAL_OC_WR(ch, t)      ((&TC0)[ch] = (t))
+#define HAL_OC_ACK(ch)        (TFLG1 = 1 << (ch))
+#define HAL_OC_IRQ_ON(ch)     (TIE |= 1 << (ch))
+#define HAL_OC_IRQ_OFF(ch)    (TIE &= ~(1 << (ch)))
+#define HAL_OC_FORCE(ch)      (CFORC = 1 << (ch))
+#define HAL_OC7_INIT(mask)    (OC7D = 0, OC7M = (mask))
+#define HAL_OC7_DATA(d)       (OC7D = (d))
+// Channels 0..3 are in TCTL2, 4..7 in TCTL1, two bits (OMx:OLx) each
+#define HAL_OC_CTL(ch)        (*((ch) < 4 ? &TCTL2 : &TCTL1))
+#define HAL_OC_SHIFT(ch)      (((ch) & 3) << 1)
+#define HAL_OC_ACTION(ch, a)  (HAL_OC_CTL(ch) = (HAL_OC_CTL(ch) & ~(3 << HAL_OC_SHIFT(ch))) | ((a) << HAL_OC_SHIFT(ch)))
+#define HAL_OC_ACTION_RD(ch)  ((HAL_OC_CTL(ch) >> HAL_OC_SHIFT(ch)) & 3)
+
+// Real-time interrupt
+#define HAL_RTI_INIT(ctl)     (RTICTL = (ctl), CRGFLG = CRGFLG_RTIF_MASK, CRGINT |= CRGINT_RTIE_MASK)
+#define HAL_RTI_ACK()         (CRGFLG = CRGFLG_RTIF_MASK)   // write 1 to clear
+#define HAL_PPAGE()           (PPAGE)
+
+// ATD
+#define HAL_ATD_INIT()        (ATD0CTL2_ADPU = 1, HAL_DelayMs(1), ATD0CTL4 = 0x80 | CLOCK_ATD_PRS)  // 8-bit
+#define HAL_ATD_RAW(ch)       HAL_AtdConvert(ch)
+
+// SCI1
+#define HAL_SCI_INIT(bdh, bdl) (SCI1BDH = (bdh), SCI1BDL = (bdl), SCI1CR1 = 0x00, SCI1CR2 = 0x2C)
+#define HAL_SCI_RX_READY()    (SCI1SR1 & 0x20)   // RDRF
+#define HAL_SCI_RX_RAW()      (SCI1DRL)
+#define HAL_SCI_TX_READY()    (SCI1SR1 & 0x80)   // TDRE
+#define HAL_SCI_TX(c)         (SCI1DRL = (c))
+#define HAL_SCI_BAUD(bdh, bdl) (SCI1BDH = (bdh), SCI1BDL = (bdl))
+#define HAL_SCI_TX_IDLE()     (SCI1SR1 & 0x40)   // TC
+
+// LCD bus
+#define HAL_LCD_INIT()        (DDRK = 0x3F, PORTK = 0x00)   // PK0..5 outputs
+#define HAL_LCD_RD()          (PORTK)
+#define HAL_LCD_WR(v)         (PORTK = (v))
+
+// System
+#define HAL_ENABLE_INTERRUPTS()   EnableInterrupts
+#define HAL_DISABLE_INTERRUPTS()  DisableInterrupts
+#define HAL_IDLE()                Clock_Idle()   // low bus clock while polling (clock.c)
+#define HAL_DELAY_MS(ms)          HAL_DelayMs(ms)
+#define HAL_RESTART()             main()
+#define HAL_POWER_ON_RESET()      (CRGFLG & CRGFLG_PORF_MASK)
+#define HAL_POWER_ON_ACK()        (CRGFLG = CRGFLG_PORF_MASK)   // write 1 to clear
+#define HAL_TICKS()               HAL_Ticks()
+#define HAL_CLOCK_INIT()          HAL_ClockInit()
+#define HAL_CLOCK_SELECT(mode)    HAL_ClockSelect(mode)
+#define HAL_CRITICAL_ENTER(ccr)   { __asm TPA; __asm STAA ccr; __asm SEI; }
+#define HAL_CRITICAL_EXIT(ccr)    { __asm LDAA ccr; __asm TAP; }
+
+extern void main(void);
+
+//-------------------------HAL_DelayMs-------------------------
+// Busy delay, calibrated for the current bus clock (clock.h)
+// Input: milliseconds
+// Output: none
+extern void HAL_DelayMs(unsigned int ms);
+
+//-------------------------HAL_ClockInit-----------------------
+// Switches the bus clock to the PLL (CLOCK_SYNR, CLOCK_REFDV), waits for
+// lock; returns at once when the PLL already runs at full speed
+// Input: none
+// Output: none
+extern void HAL_ClockInit(void);
+
+//-------------------------HAL_ClockSelect---------------------
+// Relocks the PLL for CLOCK_FULL or CLOCK_LOW and sets the timer, modulus
+// counter and ATD prescalers and the delay loop to match; call with interrupts masked
+// and the SCI transmitter idle, then set the baud divisor
+// Input: CLOCK_FULL or CLOCK_LOW
+// Output: relock time in TCNT ticks of CLOCK_OSC_TICK_US
+extern unsigned short HAL_ClockSelect(unsigned char mode);
+
+//-------------------------HAL_AtdConvert----------------------
+// One ATD0 conversion, right justified
+// Input: channel 0..7
+// Output: 8-bit result
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+extern unsigned char HAL_AtdConvert(unsigned char ch);
+#pragma CODE_SEG DEFAULT
+
+//-------------------------HAL_Ticks---------------------------
+// Adds the TCNT ticks since the previous call to a 32-bit count
+// Input: none
+// Output: ticks since the timer started
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+extern unsigned long HAL_Ticks(void);
+#pragma CODE_SEG DEFAULT
+
+//-------------------------HAL_TicksSkip-----------------------
+// Drops the TCNT counts since the previous HAL_Ticks call, for a
+// stretch when TCNT ran at another prescaler (bench.c)
+// Input: none
+// Output: none
+extern void HAL_TicksSkip(void);
@@ -0,0 +1,121 @@
+// filename  ***************  isrstat.c  **************************
+// Per-ISR execution time and entry latency (see isrstat.h)
+
+#include "hal.h"
+#include "isrstat.h"
+#include "stackmon.h"
+#include "sci1.h"
+
+#ifdef ISR_STATS
+
+typedef struct _isrStat {
+  unsigned long entries;
+  unsigned long exits;
+  unsigned long execSum;
+  unsigned short execMin, execMax;
+  unsigned long latCount;       // entries with a due time
+  unsigned long latSum;
+  unsigned short latMin, latMax;
+} IsrStat;
+
+static IsrStat stat[STACK_ISR_COUNT];
+
+static char * const isrName[STACK_ISR_COUNT] = {
+  "MDCU", "TIMCH0", "TIMCH6", "TIMCH7", "IRQ", "EEPROM", "SCI1", "RTI"
+};
+
+
+//-------------------------ISRStat_Enter----------------------
+// Counts an ISR entry and its latency
+// Input: STACK_ISR_xxx, TCNT value the event was due at or ISRSTAT_NO_DUE
+// Output: TCNT at entry, for ISRStat_Exit
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+unsigned short ISRStat_Enter(unsigned char isr, unsigned short due) {
+  unsigned short now = HAL_TCNT();
+  unsigned short lat;
+  IsrStat *s = &stat[isr];
+
+  s->entries++;
+  if (due != ISRSTAT_NO_DUE) {
+    lat = now - due;
+    if (s->latCount == 0 || lat < s->latMin) {
+      s->latMin = lat;
+    }
+    if (lat > s->latMax) {
+      s->latMax = lat;
+    }
+    s->latSum += lat;
+    s->latCount++;
+  }
+  return now;
+}
+
+//-------------------------ISRStat_Exit-----------------------
+// Records the execution time of an ISR
+// Input: STACK_ISR_xxx, TCNT at entry
+// Output: none
+void ISRStat_Exit(unsigned char isr, unsigned short start) {
+  unsigned short t = HAL_TCNT() - start;
+  IsrStat *s = &stat[isr];
+
+  if (s->exits == 0 || t < s->execMin) {
+    s->execMin = t;
+  }
+  if (t > s->execMax) {
+    s->execMax = t;
+  }
+  s->execSum += t;
+  s->exits++;
+}
+#pragma CODE_SEG DEFAULT
+
+// Counts above 65535 in two parts
+static void outULong(unsigned long n) {
+  if (n >= 10000) {
+    SCI1_OutUDec((unsigned short)(n / 10000));
+    n %= 10000;
+    SCI1_OutChar('0' + (char)(n / 1000));
+    SCI1_OutChar('0' + (char)(n / 100 % 10));
+    SCI1_OutChar('0' + (char)(n / 10 % 10));
+    SCI1_OutChar('0' + (char)(n % 10));
+  } else {
+    SCI1_OutUDec((unsigned short)n);
+  }
+}
+
+// min/mean/max of one column
+static void outTriple(unsigned short min, unsigned long sum, unsigned long n, unsigned short max) {
+  if (n == 0) {
+    SCI1_OutString(" -");
+    return;
+  }
+  SCI1_OutChar(' ');SCI1_OutUDec(min);
+  SCI1_OutChar('/');SCI1_OutUDec((unsigned short)(sum / n));
+  SCI1_OutChar('/');SCI1_OutUDec(max);
+}
+
+//-------------------------ISRStat_Report---------------------
+// Prints entries, exits, min/mean/max execution time and latency per ISR
+// over SCI1, in TCNT ticks
+// Input: none
+// Output: none
+void ISRStat_Report(void) {
+  IsrStat s;
+  unsigned char i, ccr;
+
+  SCI1_OutString("ISR entries exits exec min/mean/max latency min/mean/max (ticks)");
+  SCI1_OutChar(CR);SCI1_OutChar(LF);
+  for (i = 0; i < STACK_ISR_COUNT; i++) {
+    HAL_CRITICAL_ENTER(ccr);
+    s = stat[i];   // consistent copy, the ISR may run meanwhile
+    HAL_CRITICAL_EXIT(ccr);
+    SCI1_OutString("  ");SCI1_OutString(isrName[i]);
+    SCI1_OutChar(' ');outULong(s.entries);
+    SCI1_OutChar(' ');outULong(s.exits);
+    outTriple(s.execMin, s.execSum, s.exits, s.execMax);
+    outTriple(s.latMin, s.latSum, s.latCount, s.latMax);
+    SCI1_OutChar(CR);SCI1_OutChar(LF);
+  }
+}
+
+#endif
@@ -0,0 +1,50 @@
+// filename  ***************  isrstat.h  **************************
+// Per-ISR execution time and entry latency, measured with TCNT
+//
+// ISRSTAT_ENTER samples TCNT first thing in the ISR and records how late
+// the ISR started against the counter value its event was due at (the
+// compare value of an output compare channel; the modulus counter tick
+// has none). ISRSTAT_EXIT records the execution time at the end. Times
+// are TCNT ticks, 2.67 us (CLOCK_TIMER_HZ, clock.h). An ISR that restarts
+// main() never exits, so it shows more entries than exits. The 'I'
+// command prints the table (ISRStat_Report).
+//
+// A release build (RELEASE defined) leaves all of it out.
+
+#ifndef RELEASE
+#define ISR_STATS
+#endif
+
+#define ISRSTAT_NO_DUE  0xFFFF  // no scheduled time, latency not measured
+
+#ifdef ISR_STATS
+// isr: STACK_ISR_xxx (stackmon.h), due: TCNT value the event was due at
+#define ISRSTAT_ENTER(isr, due)  unsigned short isrStatStart = ISRStat_Enter(isr, due)
+#define ISRSTAT_EXIT(isr)        ISRStat_Exit(isr, isrStatStart)
+#else
+#define ISRSTAT_ENTER(isr, due)
+#define ISRSTAT_EXIT(isr)
+#endif
+
+#ifdef ISR_STATS
+//-------------------------ISRStat_Enter----------------------
+// Counts an ISR entry and its latency
+// Input: STACK_ISR_xxx, TCNT value the event was due at or ISRSTAT_NO_DUE
+// Output: TCNT at entry, for ISRStat_Exit
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+extern unsigned short ISRStat_Enter(unsigned char isr, unsigned short due);
+
+//-------------------------ISRStat_Exit-----------------------
+// Records the execution time of an ISR
+// Input: STACK_ISR_xxx, TCNT at entry
+// Output: none
+extern void ISRStat_Exit(unsigned char isr, unsigned short start);
+#pragma CODE_SEG DEFAULT
+
+//-------------------------ISRStat_Report---------------------
+// Prints entries, exits, min/mean/max execution time and latency per ISR
+// over SCI1, in TCNT ticks
+// Input: none
+// Output: none
+extern void ISRStat_Report(void);
+#endif
@@ -15,8 +15,10 @@
 //  PM7 ------- Data Bit 7 of LCD
 //
 //===============================================================================
-#include "derivative.h"
+#include "hal.h"
 #include "lcd.h"
+#include "fixpt.h"
+#include "pool.h"
 #include <stdio.h>
 
 //===============================================================================
@@ -73,8 +75,8 @@ int _trimlen(char * s)
 // Delay
 //===============================================================================
 void delay(byte ms)
-{   int i,j;
-for(i=0;i<(ms*100);i++)for(j=0;j<14;j++) asm("nop\n");
+{
+  HAL_DELAY_MS(ms);
 
 
 }
@@ -94,10 +96,10 @@ void LCDWriteNibble(byte n)
 #else
   n >>= 2;
   n &= 0x3c;
-  PORTK &= ~0x3c;         // zero out the bits
-  PORTK |= n;             // set the bits.
-  PORTK |= LCD_ENABLE;    // Strobe the data in
-  PORTK &= ~LCD_ENABLE;
+  HAL_LCD_WR(HAL_LCD_RD() & ~0x3c);          // zero out the bits
+  HAL_LCD_WR(HAL_LCD_RD() | n);              // set the bits.
+  HAL_LCD_WR(HAL_LCD_RD() | LCD_ENABLE);     // Strobe the data in
+  HAL_LCD_WR(HAL_LCD_RD() & ~LCD_ENABLE);
 #endif  
   delay(1);    
 }
@@ -110,7 +112,7 @@ void LCDWriteChar( byte d )
 #ifdef miniDragon  
   PTM |= LCD_WRITE_DATA;   // Set the command data line to data.
 #else
-  PORTK |=  LCD_WRITE_DATA;
+  HAL_LCD_WR(HAL_LCD_RD() | LCD_WRITE_DATA);
 #endif  
 
   LCDWriteNibble(d);      // Write the upper nibble.
@@ -129,8 +131,7 @@ void LCD_Init()
   DDRM = 0xff;          // LCD set portm pins to output
   PTM = 0;
 #else
-  DDRK =  0x3f;         // PK[0:5] Output
-  PORTK = 0;
+  HAL_LCD_INIT();       // PK[0:5] Output, all low
 #endif
 
   delay(100);            // Wait 15ms for first command.
@@ -161,7 +162,7 @@ void LCDWriteLine(byte line, char* d)
 #ifdef miniDragon  
   PTM = 0;
 #else
-  PORTK &= ~LCD_WRITE_DATA;
+  HAL_LCD_WR(HAL_LCD_RD() & ~LCD_WRITE_DATA);
 #endif  
   c = _line_control[line-1] | LCD_SET_ADDRESS;
   
@@ -183,12 +184,14 @@ void LCDWriteLine(byte line, char* d)
 }
 
 void LCDWriteInt(int num) {
-  char Voutbuf[50];   /*Creates a char Voutbuffer */
+  char *Voutbuf = Pool_Alloc(POOL_TEXT);   /* "-32768", off the 256-byte stack */
   byte c=0;
   char *d;
+  if(Voutbuf == 0)
+    return;
   sprintf(Voutbuf,"%d",num);
   d=Voutbuf;
-  PORTK &= ~LCD_WRITE_DATA;
+  HAL_LCD_WR(HAL_LCD_RD() & ~LCD_WRITE_DATA);
       
   while( *d && (c < LCD_WIDTH) )
   {
@@ -197,17 +200,17 @@ void LCDWriteInt(int num) {
     LCDWriteChar(*(d++));
     c++;
   }
-
+  Pool_Free(POOL_TEXT, Voutbuf);
   
 }
 
-void LCDWriteFloat(float num) {
-  char Voutbuf[50];   /*Creates a char Voutbuffer */
+void LCDWriteFixed(Fix num, byte decimals) {
+  char Voutbuf[12];   /*Creates a char Voutbuffer */
   byte c=0;
   char *d;
-  sprintf(Voutbuf,"%4.4f",num);
+  Fix_Format(Voutbuf,num,decimals);
   d=Voutbuf;
-  PORTK &= ~LCD_WRITE_DATA;
+  HAL_LCD_WR(HAL_LCD_RD() & ~LCD_WRITE_DATA);
       
   while( *d && (c < LCD_WIDTH) )
   {
@@ -219,7 +222,7 @@ void LCDWriteFloat(float num) {
 
 }
 
-void LCD_clear_line(line) {
+void LCD_clear_line(byte line) {
 LCDWriteLine(line,"                ");
 }
 
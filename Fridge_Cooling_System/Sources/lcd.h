@@ -2,6 +2,8 @@
 // LCD Routines
 //===============================================================================
 
+#include "fixpt.h"
+
 typedef struct _scrollData
 {
    word LCDstartDelay;
@@ -48,9 +50,10 @@ typedef struct _scrollData
 void LCD_Init(void);
 void LCDUpdateScroll(void);
 void LCDWriteLine(byte line, char* d);
+void LCDWriteChar(byte d);
 void LCDWriteInt( int num);
-void LCDWriteFloat( float num);
-void LCD_clear_line(int line); 
+void LCDWriteFixed( Fix num, byte decimals);
+void LCD_clear_line(byte line); 
 void LCD_clear_disp(void);
 void LCDScrollLine(byte line, char* d );
 ScrollData* LCDSetStartDelay( int which, word delay);
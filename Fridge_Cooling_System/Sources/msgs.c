@@ -0,0 +1,80 @@
+// filename  ***************  msgs.c  *****************************
+// Operator messages by number
+
+#include "msgs.h"
+#include "sci1.h"
+
+
+#if defined(MSG_TEXT) && defined(MSG_PACKED)
+#include "msgs_packed.h"   // msgText[], msgStart[], msgDict[], msgDictStart[]
+#elif defined(MSG_TEXT)
+#define MSG(id, args, text)  text,
+static char * const msgText[MSG_COUNT] = {
+#include "msgs.def"
+};
+#undef MSG
+#else
+#define MSG(id, args, text)  args,
+static const unsigned char msgArgs[MSG_COUNT] = {
+#include "msgs.def"
+};
+#undef MSG
+#endif
+
+
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+#if defined(MSG_TEXT)
+//-------------------------MSG_OutText-------------------------
+// Prints a text, %u takes the next argument
+// Input: text (packed: dictionary codes 0x80 and up), argument array
+// Output: none
+static void MSG_OutText(const unsigned char *t, unsigned short *arg) {
+  unsigned char c;
+
+  while ((c = *t++) != 0) {
+#if defined(MSG_PACKED)
+    if (c >= 0x80) {
+      MSG_OutText(&msgDict[msgDictStart[c - 0x80]], arg);
+      continue;   // dictionary entries hold no %u
+    }
+#endif
+    if (c == '%' && *t == 'u') {
+      SCI1_OutUDec(*arg++);
+      t++;
+    } else {
+      SCI1_OutChar(c);
+    }
+  }
+}
+#endif
+
+//-------------------------MSG_Send----------------------------
+// Sends one message over SCI1, muted like SCI1_OutChar
+// Input: MSG_xxx, arguments for the %u in the text (unused ones ignored)
+// Output: none
+void MSG_Send(unsigned char id, unsigned short a, unsigned short b) {
+#if defined(MSG_TEXT)
+  unsigned short arg[2];
+
+  arg[0] = a;
+  arg[1] = b;
+#if defined(MSG_PACKED)
+  MSG_OutText(&msgText[msgStart[id]], arg);
+#else
+  MSG_OutText((const unsigned char *)msgText[id], arg);
+#endif
+  SCI1_OutChar(LF);SCI1_OutChar(CR);
+#else
+  unsigned char n = msgArgs[id];
+
+  SCI1_OutChar(MSG_FRAME);
+  SCI1_OutChar(id);
+  if (n > 0) {
+    SCI1_OutChar((char)(a >> 8));SCI1_OutChar((char)a);
+  }
+  if (n > 1) {
+    SCI1_OutChar((char)(b >> 8));SCI1_OutChar((char)b);
+  }
+#endif
+}
+#pragma CODE_SEG DEFAULT
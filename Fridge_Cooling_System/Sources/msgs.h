@@ -0,0 +1,33 @@
+// filename  ***************  msgs.h  *****************************
+// Operator messages by number
+//
+// All messages live in msgs.def. By default the firmware holds none of
+// the texts: a message goes out as a short frame
+//   MSG_FRAME id [arg_hi arg_lo]...
+// with one 16-bit argument per %u in the text, and tools/msgs_expand.py
+// turns the frames back into lines on the host. Other SCI output passes
+// through the expander unchanged.
+//
+// MSG_TEXT sends the expanded lines instead, for a plain terminal. With
+// MSG_PACKED as well, the texts are stored dictionary compressed
+// (msgs_packed.h, generated by tools/msgs_pack.py).
+
+//#define MSG_TEXT
+//#define MSG_PACKED
+
+#define MSG_FRAME  0x1E   // ASCII RS, never part of the text output
+
+#define MSG(id, args, text)  id,
+enum {
+#include "msgs.def"
+  MSG_COUNT
+};
+#undef MSG
+
+//-------------------------MSG_Send----------------------------
+// Sends one message over SCI1, muted like SCI1_OutChar
+// Input: MSG_xxx, arguments for the %u in the text (unused ones ignored)
+// Output: none
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+extern void MSG_Send(unsigned char id, unsigned short a, unsigned short b);
+#pragma CODE_SEG DEFAULT
@@ -0,0 +1,38 @@
+// filename  ***************  msgs_packed.h  **********************
+// Dictionary compressed message texts for msgs.c (MSG_TEXT + MSG_PACKED)
+// Generated by tools/msgs_pack.py from msgs.def, do not edit.
+// 353 bytes of tables instead of 423 for the plain texts
+
+static const unsigned char msgDict[] = {
+  0x52, 0x65, 0x66, 0x72, 0x69, 0x67, 0x65, 0x72, 0x61, 0x74, 0x6F, 0x72, 0x20, 0x00,  // 0x80 "Refrigerator "
+  0x5A, 0x6F, 0x6E, 0x65, 0x20, 0x00,  // 0x81 "Zone "
+  0x20, 0x69, 0x73, 0x20, 0x00,  // 0x82 " is "
+  0x74, 0x65, 0x6D, 0x70, 0x65, 0x72, 0x61, 0x74, 0x75, 0x72, 0x65, 0x20, 0x00,  // 0x83 "temperature "
+  0x74, 0x69, 0x6E, 0x67, 0x00,  // 0x84 "ting"
+  0x57, 0x41, 0x52, 0x4E, 0x49, 0x4E, 0x47, 0x21, 0x20, 0x00,  // 0x85 "WARNING! "
+  0x20, 0x66, 0x61, 0x00,  // 0x86 " fa"
+};
+static const unsigned short msgDictStart[] = {
+  0, 14, 20, 25, 38, 43, 53
+};
+
+static const unsigned char msgText[] = {
+  0x52, 0x65, 0x73, 0x65, 0x74, 0x20, 0x25, 0x75, 0x2C, 0x20, 0x6D, 0x61, 0x69, 0x6E, 0x28, 0x29, 0x20, 0x61, 0x66, 0x74, 0x65, 0x72, 0x20, 0x25, 0x75, 0x20, 0x63, 0x79, 0x63, 0x6C, 0x65, 0x73, 0x00,  // MSG_RESET
+  0x80, 0x67, 0x6F, 0x74, 0x20, 0x74, 0x75, 0x72, 0x6E, 0x65, 0x64, 0x20, 0x4F, 0x4E, 0x00,  // MSG_REF_STARTED
+  0x80, 0x69, 0x73, 0x20, 0x4F, 0x4E, 0x00,  // MSG_REF_ON
+  0x80, 0x69, 0x73, 0x20, 0x4F, 0x46, 0x46, 0x00,  // MSG_REF_OFF
+  0x80, 0x83, 0x28, 0x46, 0x29, 0x3A, 0x20, 0x25, 0x75, 0x00,  // MSG_CUR_TEMP
+  0x85, 0x44, 0x6F, 0x6F, 0x72, 0x82, 0x6F, 0x70, 0x65, 0x6E, 0x00,  // MSG_DOOR_OPEN
+  0x85, 0x53, 0x74, 0x61, 0x63, 0x6B, 0x20, 0x6F, 0x76, 0x65, 0x72, 0x66, 0x6C, 0x6F, 0x77, 0x00,  // MSG_STACK_OVERFLOW
+  0x4F, 0x76, 0x65, 0x72, 0x68, 0x65, 0x61, 0x84, 0x00,  // MSG_OVERHEATING
+  0x4E, 0x75, 0x6D, 0x62, 0x65, 0x72, 0x20, 0x6F, 0x66, 0x20, 0x7A, 0x6F, 0x6E, 0x65, 0x73, 0x20, 0x63, 0x68, 0x6F, 0x73, 0x65, 0x6E, 0x3A, 0x20, 0x25, 0x75, 0x00,  // MSG_ZONES
+  0x81, 0x25, 0x75, 0x20, 0x83, 0x73, 0x70, 0x65, 0x63, 0x69, 0x66, 0x69, 0x65, 0x64, 0x82, 0x25, 0x75, 0x00,  // MSG_ZONE_TEMP
+  0x81, 0x73, 0x65, 0x74, 0x84, 0x73, 0x20, 0x72, 0x65, 0x73, 0x74, 0x6F, 0x72, 0x65, 0x64, 0x20, 0x66, 0x72, 0x6F, 0x6D, 0x20, 0x45, 0x45, 0x50, 0x52, 0x4F, 0x4D, 0x00,  // MSG_SETTINGS_RESTORED
+  0x53, 0x61, 0x76, 0x69, 0x6E, 0x67, 0x20, 0x7A, 0x6F, 0x6E, 0x65, 0x20, 0x73, 0x65, 0x74, 0x84, 0x73, 0x86, 0x69, 0x6C, 0x65, 0x64, 0x00,  // MSG_SETTINGS_FAILED
+  0x81, 0x25, 0x75, 0x86, 0x6E, 0x82, 0x4F, 0x46, 0x46, 0x00,  // MSG_FAN_OFF
+  0x81, 0x25, 0x75, 0x86, 0x6E, 0x20, 0x73, 0x70, 0x65, 0x65, 0x64, 0x82, 0x61, 0x74, 0x20, 0x6C, 0x65, 0x76, 0x65, 0x6C, 0x20, 0x25, 0x75, 0x00,  // MSG_FAN_LEVEL
+  0x81, 0x25, 0x75, 0x86, 0x6E, 0x82, 0x6F, 0x70, 0x65, 0x72, 0x61, 0x84, 0x00,  // MSG_FAN_RUNNING
+};
+static const unsigned short msgStart[MSG_COUNT] = {
+  0, 33, 48, 55, 63, 73, 84, 100, 109, 136, 154, 182, 205, 215, 239
+};
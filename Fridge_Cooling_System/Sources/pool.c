@@ -0,0 +1,138 @@
+// filename  ***************  pool.c  *****************************
+// Fixed-block memory pools (see pool.h)
+
+#include "hal.h"
+#include "pool.h"
+#include "sci1.h"
+
+#define POOL_NONE  0xFF   // end of a free list
+
+#define POOL(id, size, blocks) \
+  POOL_CHECK(id##_size, (size) >= 1 && (blocks) >= 1 && (blocks) < POOL_NONE);
+#include "pools.def"
+#undef POOL
+
+// All blocks in one RAM object, so sizeof() is the total
+#define POOL(id, size, blocks)  unsigned char id##_mem[(blocks) * (size)];
+static struct _poolMem {
+#include "pools.def"
+} poolMem;
+#undef POOL
+
+POOL_CHECK(pool_budget, sizeof(struct _poolMem) <= POOL_RAM_BUDGET);
+// Pools and stack together leave at least half the RAM segment to variables
+POOL_CHECK(pool_ram, POOL_RAM_BUDGET + POOL_STACK_SIZE <= (POOL_RAM_END - POOL_RAM_START + 1) / 2);
+
+typedef struct _poolDef {
+  unsigned char *mem;
+  unsigned short size;      // bytes per block
+  unsigned char blocks;
+  char *name;
+} PoolDef;
+
+#define POOL(id, size, blocks)  { poolMem.id##_mem, size, blocks, #id },
+static const PoolDef poolDef[POOL_COUNT] = {
+#include "pools.def"
+};
+#undef POOL
+
+typedef struct _poolStat {
+  unsigned char free;       // first free block, POOL_NONE when exhausted
+  unsigned char used;
+  unsigned char peak;       // most blocks in use at once since reset
+  unsigned char fails;      // Pool_Alloc calls that found no block, saturates
+} PoolStat;
+
+static PoolStat stat[POOL_COUNT];
+
+
+//-------------------------Pool_Init--------------------------
+// Frees every block, keeps the peak and failure counts
+// Input: none
+// Output: none
+void Pool_Init(void) {
+  unsigned char p, i;
+  const PoolDef *d;
+
+  for (p = 0; p < POOL_COUNT; p++) {
+    d = &poolDef[p];
+    for (i = 0; i < d->blocks; i++) {   // block i links to block i + 1
+      d->mem[i * d->size] = i + 1 < d->blocks ? i + 1 : POOL_NONE;
+    }
+    stat[p].free = 0;
+    stat[p].used = 0;
+  }
+}
+
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+//-------------------------Pool_Alloc-------------------------
+// Takes a block from a pool
+// Input: POOL_xxx
+// Output: block of the pool's block size, NULL if all are in use
+void *Pool_Alloc(unsigned char pool) {
+  const PoolDef *d = &poolDef[pool];
+  PoolStat *s = &stat[pool];
+  unsigned char *block = 0;
+  unsigned char ccr;
+
+  HAL_CRITICAL_ENTER(ccr);
+  if (s->free != POOL_NONE) {
+    block = d->mem + s->free * d->size;
+    s->free = block[0];
+    if (++s->used > s->peak) {
+      s->peak = s->used;
+    }
+  } else if (s->fails != 0xFF) {
+    s->fails++;
+  }
+  HAL_CRITICAL_EXIT(ccr);
+  return block;
+}
+
+//-------------------------Pool_Free--------------------------
+// Returns a block to the pool it was taken from
+// Input: POOL_xxx, block from Pool_Alloc (NULL is ignored)
+// Output: none
+void Pool_Free(unsigned char pool, void *block) {
+  const PoolDef *d = &poolDef[pool];
+  PoolStat *s = &stat[pool];
+  unsigned char *b = block;
+  unsigned char ccr;
+
+  if (b == 0) {
+    return;
+  }
+  HAL_CRITICAL_ENTER(ccr);
+  b[0] = s->free;
+  s->free = (unsigned char)((b - d->mem) / d->size);
+  s->used--;
+  HAL_CRITICAL_EXIT(ccr);
+}
+#pragma CODE_SEG DEFAULT
+
+//-------------------------Pool_Report------------------------
+// Prints block size, blocks, in use, peak and failed allocations per pool
+// over SCI1
+// Input: none
+// Output: none
+void Pool_Report(void) {
+  PoolStat s;
+  unsigned char p, ccr;
+
+  SCI1_OutString("Pool size blocks used peak fails, ");
+  SCI1_OutUDec(sizeof(struct _poolMem));SCI1_OutString(" of ");
+  SCI1_OutUDec(POOL_RAM_BUDGET);SCI1_OutString(" bytes");
+  SCI1_OutChar(CR);SCI1_OutChar(LF);
+  for (p = 0; p < POOL_COUNT; p++) {
+    HAL_CRITICAL_ENTER(ccr);
+    s = stat[p];   // consistent copy, an ISR may allocate meanwhile
+    HAL_CRITICAL_EXIT(ccr);
+    SCI1_OutString("  ");SCI1_OutString(poolDef[p].name);
+    SCI1_OutChar(' ');SCI1_OutUDec(poolDef[p].size);
+    SCI1_OutChar(' ');SCI1_OutUDec(poolDef[p].blocks);
+    SCI1_OutChar(' ');SCI1_OutUDec(s.used);
+    SCI1_OutChar(' ');SCI1_OutUDec(s.peak);
+    SCI1_OutChar(' ');SCI1_OutUDec(s.fails);
+    SCI1_OutChar(CR);SCI1_OutChar(LF);
+  }
+}
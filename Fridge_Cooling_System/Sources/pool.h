@@ -0,0 +1,68 @@
+// filename  ***************  pool.h  *****************************
+// Fixed-block memory pools
+//
+// There is no heap. Buffers that are only needed while a command, a
+// report or a formatting call runs come from the pools in pools.def
+// instead of each module keeping its own array. Every pool is a static
+// array of equal blocks with a free list threaded through the first byte
+// of the free blocks, so Pool_Alloc and Pool_Free take constant time.
+// Both mask interrupts for a few instructions and can be used from ISRs.
+// Blocks are not cleared, and they don't survive a main() restart
+// (Pool_Init). Used/peak/failed counts per pool are printed by the 'M'
+// command (Pool_Report).
+//
+// pool.c fails to compile if a pool is empty or too large, or if all of
+// them together exceed POOL_RAM_BUDGET, which in turn is checked against
+// the RAM segment and STACKSIZE of Project.prm.
+
+#define POOL_RAM_START   0x1000  // Project.prm: RAM = READ_WRITE 0x1000 TO 0x3FEF
+#define POOL_RAM_END     0x3FEF
+#define POOL_STACK_SIZE  0x100   // Project.prm: STACKSIZE
+#define POOL_RAM_BUDGET  512     // bytes all pools together may take
+
+#define POOL(id, size, blocks)  id,
+enum {
+#include "pools.def"
+  POOL_COUNT
+};
+#undef POOL
+
+// Block sizes, POOL_xxx_SIZE
+#define POOL(id, size, blocks)  id##_SIZE = (size),
+enum {
+#include "pools.def"
+  POOL_SIZES_END
+};
+#undef POOL
+
+// Compile-time check, a negative array size stops the build
+#define POOL_CHECK(name, cond)  typedef char name[(cond) ? 1 : -1]
+
+//-------------------------Pool_Init--------------------------
+// Frees every block, keeps the peak and failure counts
+// Input: none
+// Output: none
+extern void Pool_Init(void);
+
+//-------------------------Pool_Alloc-------------------------
+// Takes a block from a pool
+// Input: POOL_xxx
+// Output: block of the pool's block size, NULL if all are in use
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+extern void *Pool_Alloc(unsigned char pool);
+#pragma CODE_SEG DEFAULT
+
+//-------------------------Pool_Free--------------------------
+// Returns a block to the pool it was taken from
+// Input: POOL_xxx, block from Pool_Alloc (NULL is ignored)
+// Output: none
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+extern void Pool_Free(unsigned char pool, void *block);
+#pragma CODE_SEG DEFAULT
+
+//-------------------------Pool_Report------------------------
+// Prints block size, blocks, in use, peak and failed allocations per pool
+// over SCI1
+// Input: none
+// Output: none
+extern void Pool_Report(void);
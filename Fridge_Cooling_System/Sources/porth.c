@@ -0,0 +1,113 @@
+// filename  ***************  porth.c  ****************************
+// Port H (DIP switches) input service
+// Debounced, timestamped edge capture for the eight DIP switch lines.
+// PORTH_Sample runs in the timer channel 6 interrupt, everything else
+// is called from the main loop.
+
+#include "hal.h"             /* port H and TCNT through the HAL */
+#include "porth.h"
+#include "spsc.h"            /* event ring shared with the main loop */
+
+
+static volatile unsigned char debounced;  // debounced port state
+static unsigned char ct0, ct1;            // 2-bit vertical counter, one per line
+
+SPSC_DEFINE(events, PortHEvent, PORTH_EVENTS);  // PORTH_Sample to PORTH_GetEvent
+
+static unsigned short riseCount[8];
+static unsigned short fallCount[8];
+
+
+//-------------------------PORTH_Init------------------------
+// Configures port H as input, all lines start debounced low
+// Input: none
+// Output: none
+void PORTH_Init(void) {
+  unsigned char i;
+
+  HAL_DIP_INIT();  // input, no edge interrupts (lines are sampled by the tick)
+
+  // From the rest state (door closed, power off), so a switch that is
+  // already active posts its event once debounced, like any other edge
+  debounced = 0;
+  ct0 = ct1 = 0xFF;
+  Spsc_Reset(&events);
+  for (i = 0; i < 8; i++) {
+    riseCount[i] = fallCount[i] = 0;
+  }
+}
+
+//-------------------------PORTH_Sample----------------------
+// Debounces one sample of PTH, must be called every PORTH_TICK_COUNTS
+// Input: none
+// Output: none
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+void PORTH_Sample(void) {
+  unsigned char toggled, rise, fall, line;
+  PortHEvent ev;
+
+  // Vertical counter: a line's counter is reset to 3 while input matches
+  // the debounced state and counts down on every differing sample.
+  // It only toggles the debounced bit after four differing samples in a row.
+  toggled = debounced ^ HAL_DIP_RD();
+  ct0 = ~(ct0 & toggled);
+  ct1 = ct0 ^ (ct1 & toggled);
+  toggled &= ct0 & ct1;
+  if (toggled == 0) {
+    return;
+  }
+  debounced ^= toggled;
+
+  ev.stamp = HAL_TCNT();
+  ev.state = debounced;
+  ev.changed = toggled;
+  (void)Spsc_Put(&events, &ev);   // counted as dropped when full
+
+  rise = toggled & debounced;
+  fall = toggled & ~debounced;
+  for (line = 0; line < 8; line++) {
+    if (rise & 0x01) riseCount[line]++;
+    if (fall & 0x01) fallCount[line]++;
+    rise >>= 1;
+    fall >>= 1;
+  }
+}
+#pragma CODE_SEG DEFAULT
+
+//-------------------------PORTH_State-----------------------
+// Debounced state of all eight lines
+// Input: none
+// Output: debounced PTH value
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+unsigned char PORTH_State(void) {
+  return debounced;
+}
+#pragma CODE_SEG DEFAULT
+
+//-------------------------PORTH_GetEvent--------------------
+// Removes the oldest transition from the event ring
+// Input: pointer to the event to fill
+// Output: TRUE if an event was returned, FALSE if the ring is empty
+char PORTH_GetEvent(PortHEvent *ev) {
+  return Spsc_Get(&events, ev);
+}
+
+//-------------------------PORTH_RiseCount/PORTH_FallCount---
+// Number of debounced rising/falling edges seen on a line since init
+// Input: line number 0..7
+// Output: 16-bit edge count (wraps around)
+unsigned short PORTH_RiseCount(unsigned char line) {
+  return riseCount[line & 7];   // single LDD, cannot tear against the tick
+}
+
+unsigned short PORTH_FallCount(unsigned char line) {
+  return fallCount[line & 7];
+}
+
+//-------------------------PORTH_Dropped---------------------
+// Number of events lost because the ring was full
+// Input: none
+// Output: 8-bit drop count (saturates at 255)
+unsigned char PORTH_Dropped(void) {
+  return Spsc_Dropped(&events);
+}
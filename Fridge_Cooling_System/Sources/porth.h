@@ -0,0 +1,67 @@
+// filename  ***************  porth.h  ****************************
+// Port H (DIP switches) input service
+//
+// PTH is sampled from a periodic timer tick instead of edge interrupts.
+// All eight lines are debounced with a 2-bit vertical counter, so a line
+// only changes state after PORTH_TICK_COUNTS * 4 of stable input.
+// Every debounced transition is timestamped with TCNT and queued into a
+// small event ring, and rising/falling edges are counted per line.
+
+// Line assignment on the Dragon12 DIP switch bank
+#define PORTH_TEMP_MASK   0x1F  // PTH0..PTH4: simulated temperature
+#define PORTH_POWER_BIT   0x40  // PTH6: refrigerator on/off switch
+#define PORTH_DOOR_BIT    0x80  // PTH7: door switch (1 = open)
+
+// Sampling period in timer counts (CLOCK_TIMER_HZ, clock.h)
+#define PORTH_TICK_COUNTS CLOCK_US_TO_TICKS(5000)  // 5 ms, lines settle after 20 ms
+
+#define PORTH_EVENTS      8     // event ring size, power of 2 (spsc.h)
+
+typedef struct _portHEvent
+{
+   unsigned short stamp;   // TCNT at the sample that confirmed the change
+   unsigned char state;    // debounced port state after the change
+   unsigned char changed;  // lines that changed (1 = toggled)
+} PortHEvent;
+
+//-------------------------PORTH_Init------------------------
+// Configures port H as input, all lines start debounced low: a line that
+// is high already shows up as a rising edge after the first 4 samples
+// Input: none
+// Output: none
+extern void PORTH_Init(void);
+
+//-------------------------PORTH_Sample----------------------
+// Debounces one sample of PTH, must be called every PORTH_TICK_COUNTS
+// Input: none
+// Output: none
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+extern void PORTH_Sample(void);
+#pragma CODE_SEG DEFAULT
+
+//-------------------------PORTH_State-----------------------
+// Debounced state of all eight lines
+// Input: none
+// Output: debounced PTH value
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+extern unsigned char PORTH_State(void);
+#pragma CODE_SEG DEFAULT
+
+//-------------------------PORTH_GetEvent--------------------
+// Removes the oldest transition from the event ring
+// Input: pointer to the event to fill
+// Output: TRUE if an event was returned, FALSE if the ring is empty
+extern char PORTH_GetEvent(PortHEvent *ev);
+
+//-------------------------PORTH_RiseCount/PORTH_FallCount---
+// Number of debounced rising/falling edges seen on a line since init
+// Input: line number 0..7
+// Output: 16-bit edge count (wraps around)
+extern unsigned short PORTH_RiseCount(unsigned char line);
+extern unsigned short PORTH_FallCount(unsigned char line);
+
+//-------------------------PORTH_Dropped---------------------
+// Number of events lost because the ring was full
+// Input: none
+// Output: 8-bit drop count (saturates at 255)
+extern unsigned char PORTH_Dropped(void);
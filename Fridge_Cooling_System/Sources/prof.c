@@ -0,0 +1,108 @@
+// filename  ***************  prof.c  *****************************
+// Statistical PC-sampling profiler (see prof.h)
+
+#include "hal.h"
+#include "prof.h"
+#include "sci1.h"
+
+#ifdef PROF_SAMPLES
+
+#define PROF_MASK     (PROF_SLOTS - 1)
+
+typedef struct _profSlot {
+  unsigned char page;   // PPAGE for 0x8000-0xBFFF, else 0
+  unsigned short pc;    // first address of the range
+  unsigned short count; // 0: free slot, saturates at 0xFFFF
+} ProfSlot;
+
+unsigned short profPc;
+static ProfSlot slot[PROF_SLOTS];
+static unsigned short lost;
+static unsigned char paused;   // set while the table is sent
+
+
+//-------------------------Prof_Sample------------------------
+// Counts profPc and PPAGE, RTC_Tick acknowledges the RTI
+// Called from RTI_ISR with a JSR, it has to stay near.
+// Input: none (profPc)
+// Output: none
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+void Prof_Sample(void) {
+  unsigned short pc = profPc & ~(PROF_GRAIN - 1);
+  unsigned char page = 0;
+  unsigned char i, n;
+  ProfSlot *s;
+
+  if (paused) {
+    return;
+  }
+  if (pc >= 0x8000 && pc < 0xC000) {
+    page = HAL_PPAGE();
+  }
+  i = (unsigned char)(((pc / PROF_GRAIN) ^ page) & PROF_MASK);
+  for (n = 0; n < PROF_PROBES; n++) {
+    s = &slot[i];
+    if (s->count == 0) {
+      s->page = page;
+      s->pc = pc;
+    }
+    if (s->pc == pc && s->page == page) {
+      if (s->count != 0xFFFF) {
+        s->count++;
+      }
+      break;
+    }
+    i = (i + 1) & PROF_MASK;
+  }
+  if (n == PROF_PROBES && lost != 0xFFFF) {
+    lost++;
+  }
+}
+#pragma CODE_SEG DEFAULT
+
+// One byte of the frame, added to the checksum
+static void outSum(unsigned char b, unsigned char *sum) {
+  SCI1_OutByte(b);
+  *sum += b;
+}
+
+//-------------------------Prof_Dump--------------------------
+// Sends the table over SCI1 as one binary frame and clears it
+// Text output is muted while the frame is sent.
+// Input: none
+// Output: none
+void Prof_Dump(void) {
+  unsigned short i, n;
+  unsigned char sum;
+
+  paused = 1;   // samples taken while sending are dropped
+  for (n = 0, i = 0; i < PROF_SLOTS; i++) {
+    if (slot[i].count) {
+      n++;
+    }
+  }
+  SCI1_Mute(1);
+  SCI1_OutByte('P');
+  SCI1_OutByte('F');
+  SCI1_OutByte(n >> 8);
+  SCI1_OutByte(n & 0xFF);
+  sum = 0;
+  for (i = 0; i < PROF_SLOTS; i++) {
+    if (slot[i].count) {
+      outSum(slot[i].page, &sum);
+      outSum(slot[i].pc >> 8, &sum);
+      outSum(slot[i].pc & 0xFF, &sum);
+      outSum(slot[i].count >> 8, &sum);
+      outSum(slot[i].count & 0xFF, &sum);
+      slot[i].count = 0;
+    }
+  }
+  outSum(lost >> 8, &sum);
+  outSum(lost & 0xFF, &sum);
+  SCI1_OutByte(sum);
+  SCI1_Mute(0);
+  lost = 0;
+  paused = 0;
+}
+
+#endif
@@ -0,0 +1,43 @@
+// filename  ***************  prof.h  *****************************
+// Statistical PC-sampling profiler on the real-time interrupt
+//
+// RTI_ISR (main.c) fetches the interrupted return address from the
+// interrupt frame and Prof_Sample counts it, together with PPAGE for
+// code in the paged window, in a table of PROF_GRAIN byte address
+// ranges. The 'P' command dumps the table (Prof_Dump) and starts a new
+// profile; tools/prof_report.py maps the ranges to functions with
+// bin/Project.map. Interrupt handlers run with the I bit set and are
+// never sampled; the time they take shows up nowhere. The RTI belongs
+// to the real-time clock (rtc.h, RTC_RTICTL); it runs at about 1 kHz,
+// unrelated to the timer, so it doesn't lock onto the fan compares.
+//
+// Dump frame: 'P' 'F' count_hi count_lo entries... lost_hi lost_lo sum
+//   entry: page pc_hi pc_lo count_hi count_lo (page 0: not paged)
+//   lost: samples that found the table full
+//   sum: 8-bit sum of the entry and lost bytes
+
+#define PROF_SAMPLES        // remove to compile the profiler out
+
+#define PROF_SLOTS    256   // address ranges, power of 2 up to 256, 5 bytes of RAM each
+#define PROF_GRAIN    8     // bytes per address range, power of 2
+#define PROF_PROBES   8     // slots tried before a sample is lost
+
+#ifdef PROF_SAMPLES
+extern unsigned short profPc;   // interrupted PC, stored by RTI_ISR
+
+//-------------------------Prof_Sample------------------------
+// Counts profPc and PPAGE, RTC_Tick acknowledges the RTI
+// Called from RTI_ISR with a JSR, it has to stay near.
+// Input: none (profPc)
+// Output: none
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+extern void Prof_Sample(void);
+#pragma CODE_SEG DEFAULT
+
+//-------------------------Prof_Dump--------------------------
+// Sends the table over SCI1 as one binary frame and clears it
+// Text output is muted while the frame is sent.
+// Input: none
+// Output: none
+extern void Prof_Dump(void);
+#endif
@@ -0,0 +1,137 @@
+// filename  ***************  rec.c  ******************************
+// Input recorder for deterministic replay (see rec.h)
+
+#include "hal.h"
+#include "sci1.h"
+
+#ifdef REC_INPUTS
+static unsigned char buf[REC_SIZE];
+static unsigned short len;          // bytes used in buf
+static unsigned char full;          // a record did not fit
+static unsigned char started;
+static unsigned long start;         // HAL_TICKS at REC_Init
+static unsigned long stamp;         // time of the last record
+static unsigned short last[REC_COUNT];  // last value per input, 0xFFFF: none yet
+#endif
+
+
+//-------------------------REC_Init---------------------------
+// Starts recording at time 0, only the first call after reset counts
+// Input: none
+// Output: none
+void REC_Init(void) {
+#ifdef REC_INPUTS
+  unsigned char i;
+
+  if (started) {
+    return;   // main() restart, keep recording
+  }
+  for (i = 0; i < REC_COUNT; i++) {
+    last[i] = 0xFFFF;
+  }
+  len = 0;
+  full = 0;
+  start = HAL_TICKS();
+  stamp = 0;
+  started = 1;
+#endif
+}
+
+//-------------------------REC_Input--------------------------
+// Records a value read from an input if it changed
+// Input: input number, value read
+// Output: the value, unchanged
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+unsigned char REC_Input(unsigned char input, unsigned char v) {
+#ifdef REC_INPUTS
+  unsigned long now, dt;
+  unsigned char rec[7], n, i, ccr;
+
+  if (!started || full) {
+    return v;
+  }
+  HAL_CRITICAL_ENTER(ccr);
+  now = HAL_TICKS() - start;   // also keeps HAL_TICKS current
+  if (last[input] != v || input == REC_SCI_RX) {
+    last[input] = v;
+    dt = now - stamp;
+    stamp = now;
+    n = 0;
+    while (dt >= 0x80) {
+      rec[n++] = (unsigned char)dt | 0x80;
+      dt >>= 7;
+    }
+    rec[n++] = (unsigned char)dt;
+    rec[n++] = input;
+    rec[n++] = v;
+    if (len + n <= REC_SIZE) {
+      for (i = 0; i < n; i++) {
+        buf[len++] = rec[i];
+      }
+    } else {
+      full = 1;
+    }
+  }
+  HAL_CRITICAL_EXIT(ccr);
+#endif
+  return v;
+}
+#pragma CODE_SEG DEFAULT
+
+//-------------------------REC_Time---------------------------
+// Ticks since REC_Init
+// Input: none
+// Output: ticks, 0 before REC_Init
+unsigned long REC_Time(void) {
+#ifdef REC_INPUTS
+  if (started) {
+    return HAL_TICKS() - start;
+  }
+#endif
+  return 0;
+}
+
+//-------------------------REC_Length-------------------------
+// Bytes recorded so far
+// Input: none
+// Output: record bytes in the buffer
+unsigned short REC_Length(void) {
+#ifdef REC_INPUTS
+  return len;
+#else
+  return 0;
+#endif
+}
+
+//-------------------------REC_Dump---------------------------
+// Sends the records over SCI1 as one binary frame
+// Text output is muted while the frame is sent.
+// Input: none
+// Output: none
+void REC_Dump(void) {
+  unsigned short i, n;
+  unsigned char sum, flags;
+
+  n = REC_Length();   // records added while sending are left out
+  flags = 0;
+#ifdef REC_INPUTS
+  if (full) {
+    flags |= REC_FULL;
+  }
+#endif
+  SCI1_Mute(1);
+  SCI1_OutByte('R');
+  SCI1_OutByte('T');
+  SCI1_OutByte(flags);
+  SCI1_OutByte(n >> 8);
+  SCI1_OutByte(n & 0xFF);
+  sum = 0;
+  for (i = 0; i < n; i++) {
+#ifdef REC_INPUTS
+    SCI1_OutByte(buf[i]);
+    sum += buf[i];
+#endif
+  }
+  SCI1_OutByte(sum);
+  SCI1_Mute(0);
+}
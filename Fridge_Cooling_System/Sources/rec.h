@@ -0,0 +1,74 @@
+// filename  ***************  rec.h  ******************************
+// Input recorder for deterministic replay
+//
+// Every input the application reads through the HAL (port H switches,
+// keypad rows, ATD conversions, SCI receive) passes REC_Input. A value
+// is recorded when it differs from the previous read of the same input,
+// SCI bytes always, each with the HAL_TICKS time since REC_Init. Records
+// fill a RAM buffer from the first start on; recording stops when it is
+// full. The 'R' command dumps it (REC_Dump), host/fridge_replay feeds it
+// back through the host HAL and diffs the outputs.
+//
+// Record: time delta in ticks (7 bits per byte, low first, bit 7 set on
+// all but the last byte), input number, value
+//
+// Dump frame: 'R' 'T' flags len_hi len_lo records... sum
+//   flags bit 0: buffer was full, later inputs are missing
+//   sum: 8-bit sum of the record bytes
+
+#define REC_INPUTS          // remove to compile the recorder out
+
+#ifndef REC_SIZE
+#define REC_SIZE      2048  // bytes of RAM for records, at most 65535
+#endif
+
+// Input numbers
+#define REC_DIP       0     // PTH
+#define REC_KEYPAD    1     // + row 0..3, port A read back
+#define REC_ATD       8     // + channel 0..7
+#define REC_SCI_RX    16    // SCI1 data register
+#define REC_COUNT     17
+
+#define REC_FULL      0x01  // dump flags
+
+// Keypad row number of a row pattern (0xFE, 0xFD, 0xFB, 0xF7)
+#define REC_ROW(row)  (((row) & 1) == 0 ? 0 : ((row) & 2) == 0 ? 1 : ((row) & 4) == 0 ? 2 : 3)
+
+#ifdef REC_INPUTS
+#define REC_IN(input, v)  REC_Input(input, v)
+#else
+#define REC_IN(input, v)  (v)
+#endif
+
+//-------------------------REC_Init---------------------------
+// Starts recording at time 0, only the first call after reset counts
+// Input: none
+// Output: none
+extern void REC_Init(void);
+
+//-------------------------REC_Input--------------------------
+// Records a value read from an input if it changed
+// Input: input number, value read
+// Output: the value, unchanged
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+extern unsigned char REC_Input(unsigned char input, unsigned char v);
+#pragma CODE_SEG DEFAULT
+
+//-------------------------REC_Time---------------------------
+// Ticks since REC_Init
+// Input: none
+// Output: ticks, 0 before REC_Init
+extern unsigned long REC_Time(void);
+
+//-------------------------REC_Length-------------------------
+// Bytes recorded so far
+// Input: none
+// Output: record bytes in the buffer
+extern unsigned short REC_Length(void);
+
+//-------------------------REC_Dump---------------------------
+// Sends the records over SCI1 as one binary frame
+// Text output is muted while the frame is sent.
+// Input: none
+// Output: none
+extern void REC_Dump(void);
@@ -0,0 +1,75 @@
+// filename  ***************  rtc.c  ******************************
+// Soft real-time clock (see rtc.h)
+
+#include "hal.h"
+#include "rtc.h"
+
+static volatile unsigned long seconds;   // since midnight
+static unsigned long part;               // TCNT ticks into the current second
+static unsigned long last;               // HAL_TICKS at the previous RTC_Tick
+static unsigned char set;                // RTC_Set called since reset
+
+//-------------------------RTC_Init---------------------------
+// Starts the RTI, the time survives main() restarts
+// Input: none
+// Output: none
+void RTC_Init(void) {
+  HAL_RTI_INIT(RTC_RTICTL);
+}
+
+//-------------------------RTC_Tick---------------------------
+// Adds the time since the previous RTI, acknowledges the RTI
+// Called from RTI_ISR with a JSR, it has to stay near.
+// Input: none
+// Output: none
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+void RTC_Tick(void) {
+  unsigned long now;
+
+  HAL_RTI_ACK();
+  now = HAL_TICKS();
+  part += now - last;   // more than one RTI period if one was lost
+  last = now;
+  while (part >= CLOCK_TIMER_HZ) {
+    part -= CLOCK_TIMER_HZ;
+    if (++seconds >= RTC_DAY) {
+      seconds = 0;
+    }
+  }
+}
+#pragma CODE_SEG DEFAULT
+
+//-------------------------RTC_Set----------------------------
+// Sets the time of day and marks the clock set
+// Input: seconds since midnight, below RTC_DAY
+// Output: none
+void RTC_Set(unsigned long s) {
+  unsigned char ccr;
+
+  HAL_CRITICAL_ENTER(ccr);
+  seconds = s % RTC_DAY;
+  part = 0;
+  HAL_CRITICAL_EXIT(ccr);
+  set = 1;
+}
+
+//-------------------------RTC_Seconds------------------------
+// Time of day
+// Input: none
+// Output: seconds since midnight
+unsigned long RTC_Seconds(void) {
+  unsigned long s;
+  unsigned char ccr;
+
+  HAL_CRITICAL_ENTER(ccr);
+  s = seconds;   // two 16-bit loads, the RTI must not come in between
+  HAL_CRITICAL_EXIT(ccr);
+  return s;
+}
+
+//-------------------------RTC_IsSet--------------------------
+// Input: none
+// Output: TRUE once RTC_Set has been called since reset
+char RTC_IsSet(void) {
+  return set;
+}
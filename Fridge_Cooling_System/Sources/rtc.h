@@ -0,0 +1,49 @@
+// filename  ***************  rtc.h  ******************************
+// Soft real-time clock on the real-time interrupt
+//
+// The RTI only paces the clock: an RTI is lost whenever interrupts stay
+// masked for more than one period. RTC_Tick takes the elapsed time from
+// HAL_TICKS instead, TCNT ticks since the previous RTI, and counts a
+// second every CLOCK_TIMER_HZ of them, so masked stretches cost nothing.
+// TCNT keeps its rate at both bus clocks but runs at 2/3 of it while the
+// PLL relocks (clock.h), the clock loses a third of every relock time
+// (Clock_Report), and it stops during the 'B' and 'F' benchmarks, which
+// run TCNT at another prescaler (bench.c), for well under 1 ms each
+// measurement. The time of day starts at 00:00:00 on reset
+// and is flagged unset until the 'K' command sets it (sched.h); a main()
+// restart keeps it. The profiler (prof.h) samples on the same interrupt.
+
+#define RTC_RTICTL      0x17     // (7 + 1) * 2^10 OSCCLK periods: 1.024 ms at 8 MHz
+#define RTC_DAY         86400UL  // seconds
+
+//-------------------------RTC_Init---------------------------
+// Starts the RTI, the time survives main() restarts
+// Input: none
+// Output: none
+extern void RTC_Init(void);
+
+//-------------------------RTC_Tick---------------------------
+// Adds the time since the previous RTI, acknowledges the RTI
+// Called from RTI_ISR with a JSR, it has to stay near.
+// Input: none
+// Output: none
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+extern void RTC_Tick(void);
+#pragma CODE_SEG DEFAULT
+
+//-------------------------RTC_Set----------------------------
+// Sets the time of day and marks the clock set
+// Input: seconds since midnight, below RTC_DAY
+// Output: none
+extern void RTC_Set(unsigned long seconds);
+
+//-------------------------RTC_Seconds------------------------
+// Time of day
+// Input: none
+// Output: seconds since midnight
+extern unsigned long RTC_Seconds(void);
+
+//-------------------------RTC_IsSet--------------------------
+// Input: none
+// Output: TRUE once RTC_Set has been called since reset
+extern char RTC_IsSet(void);
@@ -0,0 +1,175 @@
+// filename  ***************  sched.c  ****************************
+// Time-of-day set point schedule (see sched.h)
+
+#include "hal.h"
+#include "sched.h"
+#include "rtc.h"
+#include "sci1.h"
+
+typedef struct _schedEntry {
+  unsigned short minute;   // start, minutes since midnight
+  signed char offset;      // F added to the keypad set point
+  unsigned char used;
+} SchedEntry;
+
+static SchedEntry entry[SCHED_ZONES][SCHED_SLOTS];   // zeroed on reset: all unused
+
+// Entry in force for a zone, NULL without entries
+static const SchedEntry *active(unsigned char z, unsigned short minute) {
+  const SchedEntry *e, *best = 0, *last = 0;
+  unsigned char n;
+
+  for (n = 0; n < SCHED_SLOTS; n++) {
+    e = &entry[z][n];
+    if (!e->used) {
+      continue;
+    }
+    if (e->minute <= minute && (!best || e->minute > best->minute)) {
+      best = e;
+    }
+    if (!last || e->minute > last->minute) {
+      last = e;
+    }
+  }
+  return best ? best : last;   // before the first start: yesterday's last
+}
+
+//-------------------------Sched_Spec-------------------------
+// Set point of a zone at the current time of day
+// Input: zone 1 or 2, keypad set point (F)
+// Output: set point with the offset in force (F)
+unsigned char Sched_Spec(unsigned char zone, unsigned char base) {
+  const SchedEntry *e;
+  int spec;
+
+  if (!RTC_IsSet() || zone < 1 || zone > SCHED_ZONES) {
+    return base;
+  }
+  e = active(zone - 1, (unsigned short)(RTC_Seconds() / 60));
+  if (!e) {
+    return base;
+  }
+  spec = base + e->offset;
+  return spec < SCHED_MIN_SPEC ? SCHED_MIN_SPEC : (unsigned char)spec;
+}
+
+// Next command byte, 0 if none arrives within SCHED_WAIT_MS
+static char inByte(void) {
+  unsigned char ms;
+
+  for (ms = 0; ms < SCHED_WAIT_MS; ms++) {
+    if (SCI1_InStatus()) {
+      return SCI1_InChar();
+    }
+    HAL_DELAY_MS(1);
+  }
+  return 0;
+}
+
+// Reads n ASCII digits, FALSE on anything else
+static char inDigits(unsigned char n, unsigned short *value) {
+  char c;
+
+  *value = 0;
+  while (n--) {
+    c = inByte();
+    if (c < '0' || c > '9') {
+      return 0;
+    }
+    *value = *value * 10 + (c - '0');
+  }
+  return 1;
+}
+
+// Two digits with a leading zero
+static void out2(unsigned short n) {
+  SCI1_OutChar((char)('0' + n / 10));SCI1_OutChar((char)('0' + n % 10));
+}
+
+static void outBad(void) {
+  SCI1_OutChar('?');SCI1_OutChar(CR);SCI1_OutChar(LF);
+}
+
+//-------------------------Sched_ClockCommand-----------------
+// 'K': reads hhmmss from SCI1 and sets the clock
+// Input: none
+// Output: none
+void Sched_ClockCommand(void) {
+  unsigned short h, m, s;
+
+  if (!inDigits(2, &h) || !inDigits(2, &m) || !inDigits(2, &s) ||
+      h > 23 || m > 59 || s > 59) {
+    outBad();
+    return;
+  }
+  RTC_Set(h * 3600UL + m * 60 + s);
+  Sched_Report();
+}
+
+//-------------------------Sched_Command----------------------
+// 'W': reads one schedule entry from SCI1 and stores it
+// Input: none
+// Output: none
+void Sched_Command(void) {
+  unsigned short z, n, hhmm, off;
+  char sign;
+  SchedEntry *e;
+
+  if (!inDigits(1, &z) || !inDigits(1, &n) || !inDigits(4, &hhmm)) {
+    outBad();
+    return;
+  }
+  sign = inByte();
+  if (z < 1 || z > SCHED_ZONES || n >= SCHED_SLOTS || (sign != '+' && sign != '-') ||
+      !inDigits(2, &off) || off > SCHED_MAX_OFFSET ||
+      (hhmm != 9999 && (hhmm / 100 > 23 || hhmm % 100 > 59))) {
+    outBad();
+    return;
+  }
+  e = &entry[z - 1][n];
+  e->used = 0;   // main loop only, Sched_Spec can't see it half-written
+  if (hhmm != 9999) {
+    e->minute = hhmm / 100 * 60 + hhmm % 100;
+    e->offset = (signed char)(sign == '-' ? -(int)off : (int)off);
+    e->used = 1;
+  }
+  Sched_Report();
+}
+
+//-------------------------Sched_Report-----------------------
+// 'D': prints the time of day and every zone's entries over SCI1, the
+// one in force marked with '*'
+// Input: none
+// Output: none
+void Sched_Report(void) {
+  unsigned long t = RTC_Seconds();
+  const SchedEntry *e, *now;
+  unsigned char z, n;
+
+  SCI1_OutString("Time ");
+  out2((unsigned short)(t / 3600));SCI1_OutChar(':');
+  out2((unsigned short)(t / 60 % 60));SCI1_OutChar(':');
+  out2((unsigned short)(t % 60));
+  if (!RTC_IsSet()) {
+    SCI1_OutString(" (not set)");
+  }
+  SCI1_OutChar(CR);SCI1_OutChar(LF);
+  for (z = 0; z < SCHED_ZONES; z++) {
+    now = RTC_IsSet() ? active(z, (unsigned short)(t / 60)) : 0;
+    SCI1_OutString("  Zone ");SCI1_OutUDec(z + 1);SCI1_OutChar(':');
+    for (n = 0; n < SCHED_SLOTS; n++) {
+      e = &entry[z][n];
+      if (!e->used) {
+        continue;
+      }
+      SCI1_OutChar(' ');
+      if (e == now) {
+        SCI1_OutChar('*');
+      }
+      out2(e->minute / 60);SCI1_OutChar(':');out2(e->minute % 60);
+      SCI1_OutChar(e->offset < 0 ? '-' : '+');
+      SCI1_OutUDec((unsigned short)(e->offset < 0 ? -e->offset : e->offset));
+    }
+    SCI1_OutChar(CR);SCI1_OutChar(LF);
+  }
+}
@@ -0,0 +1,51 @@
+// filename  ***************  sched.h  ****************************
+// Time-of-day set point schedule per zone
+//
+// Each zone has SCHED_SLOTS entries "from hh:mm on, set point + offset".
+// The entry with the latest start at or before the time of day applies;
+// before the first start of the day the last one of the previous day
+// still does. Offsets are in F, negative for deeper cooling ahead of an
+// off-peak tariff window, positive to coast through a peak. The main
+// loop applies them to the keypad set points once the clock is set
+// (rtc.h); without a set clock or without entries nothing changes. The
+// schedule lives in RAM like the time: it survives main() restarts but
+// not a reset, tools/schedule.py loads both.
+//
+// Commands (SCI1, ASCII digits, each byte within SCHED_WAIT_MS):
+//   'K' hhmmss          sets the clock
+//   'W' z n hhmm sdd    zone z (1, 2), entry n (0..SCHED_SLOTS-1): from
+//                       hh:mm on, offset sign s ('+' or '-') and dd F;
+//                       hhmm = 9999 clears the entry
+//   'D'                 prints the time and the entries
+// 'K' and 'W' answer with the 'D' report, or "?" when malformed.
+
+#define SCHED_ZONES       2
+#define SCHED_SLOTS       4
+#define SCHED_MAX_OFFSET  20   // F either way
+#define SCHED_MIN_SPEC    10   // F, lowest set point an offset can give
+#define SCHED_WAIT_MS     100  // per command byte
+
+//-------------------------Sched_Spec-------------------------
+// Set point of a zone at the current time of day
+// Input: zone 1 or 2, keypad set point (F)
+// Output: set point with the offset in force (F)
+extern unsigned char Sched_Spec(unsigned char zone, unsigned char base);
+
+//-------------------------Sched_ClockCommand-----------------
+// 'K': reads hhmmss from SCI1 and sets the clock
+// Input: none
+// Output: none
+extern void Sched_ClockCommand(void);
+
+//-------------------------Sched_Command----------------------
+// 'W': reads one schedule entry from SCI1 and stores it
+// Input: none
+// Output: none
+extern void Sched_Command(void);
+
+//-------------------------Sched_Report-----------------------
+// 'D': prints the time of day and every zone's entries over SCI1, the
+// one in force marked with '*'
+// Input: none
+// Output: none
+extern void Sched_Report(void);
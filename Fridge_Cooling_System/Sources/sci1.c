@@ -16,45 +16,49 @@
 //
 // adapted to the Dragon12 board using SCI1            --  fw-07-04
 // allows for 24 MHz bus (PLL) and 4 MHz bus (no PLL)  -- fw-07-04
+// baud divisors computed from the current bus clock (clock.h), SCI1_Retune
  
-#include "derivative.h"      /* derivative-specific definitions */
-#include "SCI1.h"
+#include "hal.h"             /* SCI1 registers through the HAL */
+#include "sci1.h"
+#include "spsc.h"            /* receive ring between SCI1_RxService and InChar */
 
+static volatile char muted;   // drop text output during binary dumps
+static unsigned long bps;     // baud rate set by SCI1_Init, kept across clock changes
 
-#define RDRF 0x20   // Receive Data Register Full Bit
-#define TDRE 0x80   // Transmit Data Register Empty Bit
-
+SPSC_DEFINE(rxQueue, char, SCI1_RX_SIZE);  // received bytes, oldest first
 
 //-------------------------SCI1_Init------------------------
 // Initialize Serial port SCI1
 // Input: baudRate is the baud rate in bits/sec
 // Output: none
 void SCI1_Init(unsigned short baudRate) {
+  unsigned short sbr;
   
-  SCI1BDH = 0;   // br=MCLK/(16*baudRate) 
+  muted = 0;
+  Spsc_Reset(&rxQueue);
   
  
-  /* 24 MHz bus frequency (PLL is used, SYNR = 2, REFDV = 0 -> factor 6)
-     Baud rate generator: SCI1BDL/H = (24e6/16)/baudrate = 1.5e6/baudrate
+  /* Baud rate generator: SCI1BDH:BDL = (bus/16)/baudrate, bus clock from
+     clock.h (24 MHz: 1.5e6/baudrate, 115200 is 3.5 % off; 6 MHz low
+     clock: 9600 and below stay within 0.5 %)
      default baudrate: 9600 bps  (fw-07-04) */
   switch(baudRate){
-    case BAUD_2400:    SCI1BDL=113;
-                       SCI1BDH=2;   break;   // 625 (doesn't work)
-    case BAUD_4800:    SCI1BDL=56;
-                       SCI1BDH=1;   break;   // 312.5 (doesn't work)
-    case BAUD_9600:    SCI1BDL=156; break;   // works at SYSCLOCK = 48 MHz
-    case BAUD_19200:   SCI1BDL=78;  break;   // works at SYSCLOCK = 48 MHz
-    case BAUD_38400:   SCI1BDL=39;  break;   // works at SYSCLOCK = 48 MHz
-    case BAUD_57600:   SCI1BDL=26;  break;   // works at SYSCLOCK = 48 MHz
-    case BAUD_115200:  SCI1BDL=13;  break;   // works at SYSCLOCK = 48 MHz
-    default:           SCI1BDL=156;          // default: 9600 bps
+    case BAUD_2400:    bps=2400UL;   break;
+    case BAUD_4800:    bps=4800UL;   break;
+    case BAUD_9600:    bps=9600UL;   break;
+    case BAUD_19200:   bps=19200UL;  break;
+    case BAUD_38400:   bps=38400UL;  break;
+    case BAUD_57600:   bps=57600UL;  break;
+    case BAUD_115200:  bps=115200UL; break;
+    default:           bps=9600UL;          // default: 9600 bps
   }
   
  
   
   
     
-  SCI1CR1 = 0;
+  sbr = CLOCK_SCI_SBR_AT(Clock_BusHz(), bps);
+  HAL_SCI_INIT(sbr >> 8, sbr & 0xFF);   // SCI1CR1 = 0, SCI1CR2 = 0x2C
 /* bit value meaning
     7   0    LOOPS, no looping, normal
     6   0    WOMS, normal high/low outputs
@@ -64,11 +68,11 @@ void SCI1_Init(unsigned short baudRate) {
     2   0    ILT, short idle time (not applicable)
     1   0    PE, no parity
     0   0    PT, parity type (not applicable with PE=0) */ 
-  SCI1CR2 = 0x0C; 
+  // SCI1CR2 = 0x2C
 /* bit value meaning
     7   0    TIE, no transmit interrupts on TDRE
     6   0    TCIE, no transmit interrupts on TC
-    5   0    RIE, no receive interrupts on RDRF
+    5   1    RIE, receive interrupts on RDRF (SCI1_RxService)
     4   0    ILIE, no interrupts on idle
     3   1    TE, enable transmitter
     2   1    RE, enable receiver
@@ -77,14 +81,43 @@ void SCI1_Init(unsigned short baudRate) {
 
 }
     
+//-------------------------SCI1_Retune----------------------
+// Baud divisor for the SCI1_Init baud rate at the current bus clock,
+// after every Clock_ switch (with the transmitter idle)
+// Input: none
+// Output: none
+void SCI1_Retune(void) {
+  unsigned short sbr = CLOCK_SCI_SBR_AT(Clock_BusHz(), bps);
+
+  HAL_SCI_BAUD(sbr >> 8, sbr & 0xFF);
+}
+
+//-------------------------SCI1_RxService---------------------
+// Receive interrupt: moves the received byte into the receive ring,
+// bytes that don't fit are dropped
+// Input: none
+// Output: none
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+void SCI1_RxService(void) {
+  char c;
+
+  while(HAL_SCI_RX_READY()){   // reading SCI1SR1 then SCI1DRL clears RDRF
+    c = HAL_SCI_RX();
+    (void)Spsc_Put(&rxQueue, &c);
+  }
+
+}
+#pragma CODE_SEG DEFAULT
+
 //-------------------------SCI1_InChar------------------------
-// Wait for new serial port input, busy-waiting synchronization
+// Wait for new serial port input, busy-waiting on the receive ring
 // Input: none
 // Output: ASCII code for key typed
 char SCI1_InChar(void) {
+  char c;
 
-  while((SCI1SR1 & RDRF) == 0){};
-  return(SCI1DRL);
+  while(!Spsc_Get(&rxQueue, &c)){ HAL_IDLE(); }
+  return(c);
 
 }
         
@@ -93,12 +126,38 @@ char SCI1_InChar(void) {
 // busy-waiting synchronization
 // Input: 8-bit data to be transferred
 // Output: none
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
 void SCI1_OutChar(char data) {
  
-  while((SCI1SR1 & TDRE) == 0){};
-  SCI1DRL = data;
+  if(muted) return;
+  while(!HAL_SCI_TX_READY()){};
+  HAL_SCI_TX(data);
   
 }
+#pragma CODE_SEG DEFAULT
+
+//-------------------------SCI1_OutByte------------------------
+// Same as SCI1_OutChar, but also transmits while output is muted
+// Used for binary dumps
+// Input: 8-bit data to be transferred
+// Output: none
+void SCI1_OutByte(char data) {
+
+  while(!HAL_SCI_TX_READY()){};
+  HAL_SCI_TX(data);
+
+}
+
+//-------------------------SCI1_Mute---------------------------
+// Suppresses SCI1_OutChar and everything built on it, so messages
+// printed by interrupt handlers can't interleave with a binary dump
+// Input: TRUE to mute, FALSE to resume text output
+// Output: none
+void SCI1_Mute(char on) {
+
+  muted = on;
+
+}
 
    
 //-------------------------SCI1_InStatus--------------------------
@@ -109,7 +168,7 @@ void SCI1_OutChar(char data) {
 
 char SCI1_InStatus(void) {
 
-  return(SCI1SR1 & RDRF);
+  return(Spsc_Count(&rxQueue) != 0);
   
 }
 
@@ -120,7 +179,7 @@ char SCI1_InStatus(void) {
 //         FALSE if a call to OutChar will wait for output to be ready
 char SCI1_OutStatus(void) {
 
-  return(SCI1SR1 & TDRE);
+  return(HAL_SCI_TX_READY() != 0);
 
 }
 
@@ -129,6 +188,7 @@ char SCI1_OutStatus(void) {
 // Output String (NULL termination), busy-waiting synchronization
 // Input: pointer to a NULL-terminated string to be transferred
 // Output: none
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
 void SCI1_OutString(char *pt) {
 
   while(*pt) {
@@ -139,6 +199,7 @@ void SCI1_OutString(char *pt) {
   }
   
 }
+#pragma CODE_SEG DEFAULT
 
 //----------------------SCI1_InUDec-------------------------------
 // InUDec accepts ASCII input in unsigned decimal format
@@ -191,6 +252,7 @@ char character;
 // Input: 16-bit number to be transferred
 // Output: none
 // Variable format 1-5 digits with no space before or after
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
 void SCI1_OutUDec(unsigned short n){
 // This function uses recursion to convert decimal number
 //   of unspecified length as an ASCII string 
@@ -200,6 +262,7 @@ void SCI1_OutUDec(unsigned short n){
   }
   SCI1_OutChar(n+'0'); /* n is between 0 and 9 */
 }
+#pragma CODE_SEG DEFAULT
 
 
 
@@ -280,7 +343,7 @@ char character;
 
 //SCI0_OutString("enter the InString\r\n");
 
-  //character = SCI1_InChar();
+  character = SCI1_InChar();
 
 //SCI0_OutChar(character);
 
@@ -25,6 +25,8 @@
 #define BAUD_57600    6
 #define BAUD_115200   7
 
+#define SCI1_RX_SIZE  16    // receive ring, power of 2 (spsc.h)
+
 
 // standard ASCII symbols 
 #define CR   0x0D
@@ -39,7 +41,23 @@
 // Input: baudRate is the baud rate in bits/sec
 // Output: none
 extern void SCI1_Init(unsigned short baudRate);
+
+//-------------------------SCI1_Retune----------------------
+// Baud divisor for the SCI1_Init baud rate at the current bus clock,
+// after every Clock_ switch (with the transmitter idle)
+// Input: none
+// Output: none
+extern void SCI1_Retune(void);
  
+//-------------------------SCI1_RxService---------------------
+// Receive interrupt: moves the received byte into the receive ring,
+// bytes that don't fit are dropped
+// Input: none
+// Output: none
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+extern void SCI1_RxService(void);
+#pragma CODE_SEG DEFAULT
+
 //-------------------------SCI1_InStatus--------------------------
 // Checks if new input is ready, TRUE if new input is ready
 // Input: none
@@ -48,7 +66,7 @@ extern void SCI1_Init(unsigned short baudRate);
 extern char SCI1_InStatus(void);  
 
 //-------------------------SCI1_InChar------------------------
-// Wait for new serial port input, busy-waiting synchronization
+// Wait for new serial port input, busy-waiting on the receive ring
 // Input: none
 // Output: ASCII code for key typed
 extern char SCI1_InChar(void);
@@ -89,20 +107,40 @@ extern char SCI1_OutStatus(void);
 // busy-waiting synchronization
 // Input: 8-bit data to be transferred
 // Output: none
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
 extern void SCI1_OutChar(char);  
+#pragma CODE_SEG DEFAULT
+
+//-------------------------SCI1_OutByte------------------------
+// Same as SCI1_OutChar, but also transmits while output is muted
+// Used for binary dumps
+// Input: 8-bit data to be transferred
+// Output: none
+extern void SCI1_OutByte(char);
+
+//-------------------------SCI1_Mute---------------------------
+// Suppresses SCI1_OutChar and everything built on it, so messages
+// printed by interrupt handlers can't interleave with a binary dump
+// Input: TRUE to mute, FALSE to resume text output
+// Output: none
+extern void SCI1_Mute(char on);
  
 //-----------------------SCI1_OutUDec-----------------------
 // Output a 16-bit number in unsigned decimal format
 // Input: 16-bit number to be transferred
 // Output: none
 // Variable format 1-5 digits with no space before or after
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
 extern void SCI1_OutUDec(unsigned short);    
+#pragma CODE_SEG DEFAULT
 
 //-------------------------SCI1_OutString------------------------
 // Output String (NULL termination), busy-waiting synchronization
 // Input: pointer to a NULL-terminated string to be transferred
 // Output: none
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
 extern void SCI1_OutString(char *pt); 
+#pragma CODE_SEG DEFAULT
  
 //--------------------------SCI1_OutUHex----------------------------
 // Output a 16 bit number in unsigned hexadecimal format
@@ -0,0 +1,94 @@
+// filename  ***************  settings.c  *************************
+// Zone configuration persisted in EEPROM
+
+#include "eeprom.h"
+#include "settings.h"
+
+
+//-------------------------Settings_Crc-----------------------
+// CRC-16/CCITT (polynomial 0x1021, initial value 0xFFFF), bitwise
+// Input: buffer and its length
+// Output: 16-bit CRC
+static unsigned short Settings_Crc(const unsigned char *p, unsigned char len) {
+  unsigned short crc = 0xFFFF;
+  unsigned char bit;
+
+  while (len--) {
+    crc ^= (unsigned short)(*p++) << 8;
+    for (bit = 0; bit < 8; bit++) {
+      if (crc & 0x8000) {
+        crc = (crc << 1) ^ 0x1021;
+      } else {
+        crc <<= 1;
+      }
+    }
+  }
+  return crc;
+}
+
+//-------------------------Settings_Load----------------------
+// Reads and validates the settings record
+// Input: pointer to the record to fill
+// Output: TRUE if a valid record was found, FALSE otherwise
+char Settings_Load(Settings *s) {
+
+  EEPROM_Read(EE_SETTINGS_ADDR, s, sizeof(Settings));
+
+  if (s->magic != SETTINGS_MAGIC || s->version != SETTINGS_VERSION) {
+    return 0;
+  }
+  if (s->crc != Settings_Crc((const unsigned char *)s, sizeof(Settings) - 2)) {
+    return 0;
+  }
+  // A good CRC over bad values means a firmware bug, not a fresh device
+  if (s->num_of_zones != 1 && s->num_of_zones != 2) {
+    return 0;
+  }
+  if (s->temp1 < 1 || s->temp1 > 3) {
+    return 0;
+  }
+  if (s->num_of_zones == 2 && (s->temp2 < 1 || s->temp2 > 3)) {
+    return 0;
+  }
+  return 1;
+}
+
+//-------------------------Settings_Save----------------------
+// Stamps magic, version and CRC and queues the record for EEPROM
+// Programming completes in the background (EEPROM_Busy/EEPROM_Sync).
+// Input: pointer to the record, only the data fields need to be set
+// Output: TRUE if the record was accepted by the write-behind cache
+char Settings_Save(Settings *s) {
+
+  s->magic = SETTINGS_MAGIC;
+  s->version = SETTINGS_VERSION;
+  s->reserved = 0xFF;
+  s->crc = Settings_Crc((const unsigned char *)s, sizeof(Settings) - 2);
+  if (!EEPROM_Write(EE_SETTINGS_ADDR, s, sizeof(Settings))) {
+    return 0;
+  }
+  EEPROM_Flush();  // programmed in the background
+  return 1;
+}
+
+//-------------------------Settings_Invalidate----------------
+// Destroys the stored record so the next start runs the keypad dialog
+// Input: none
+// Output: TRUE if the change was accepted by the write-behind cache
+char Settings_Invalidate(void) {
+  unsigned char blank = 0x00;
+
+  if (!EEPROM_Write(EE_SETTINGS_ADDR, &blank, 1)) {  // clobber the magic byte
+    return 0;
+  }
+  EEPROM_Flush();
+  return 1;
+}
+
+//-------------------------Settings_LevelToTemp---------------
+// Converts a keypad temperature level to the zone set point
+// Input: level 1..3
+// Output: set point in F (20, 30 or 40)
+unsigned char Settings_LevelToTemp(unsigned char level) {
+  return 10 + 10 * level;
+}
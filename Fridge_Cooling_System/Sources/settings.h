@@ -0,0 +1,45 @@
+// filename  ***************  settings.h  *************************
+// Zone configuration persisted in EEPROM
+//
+// The record is versioned and CRC protected. On reset the firmware loads it
+// and resumes cooling immediately; the keypad dialog only runs when the
+// record is missing, from an older layout, or corrupt.
+
+#define SETTINGS_MAGIC    0xC5
+#define SETTINGS_VERSION  1
+
+typedef struct _settings
+{
+   unsigned char magic;         // SETTINGS_MAGIC
+   unsigned char version;       // SETTINGS_VERSION, bumped on layout change
+   unsigned char num_of_zones;  // 1 or 2
+   unsigned char temp1;         // zone 1 level 1..3
+   unsigned char temp2;         // zone 2 level 1..3 (unused with one zone)
+   unsigned char reserved;      // keeps the record a whole number of sectors
+   unsigned short crc;          // CRC-16/CCITT over all preceding bytes
+} Settings;
+
+//-------------------------Settings_Load----------------------
+// Reads and validates the settings record
+// Input: pointer to the record to fill
+// Output: TRUE if a valid record was found, FALSE otherwise
+extern char Settings_Load(Settings *s);
+
+//-------------------------Settings_Save----------------------
+// Stamps magic, version and CRC and queues the record for EEPROM
+// Programming completes in the background (EEPROM_Busy/EEPROM_Sync).
+// Input: pointer to the record, only the data fields need to be set
+// Output: TRUE if the record was accepted by the write-behind cache
+extern char Settings_Save(Settings *s);
+
+//-------------------------Settings_Invalidate----------------
+// Destroys the stored record so the next start runs the keypad dialog
+// Input: none
+// Output: TRUE if the change was accepted by the write-behind cache
+extern char Settings_Invalidate(void);
+
+//-------------------------Settings_LevelToTemp---------------
+// Converts a keypad temperature level to the zone set point
+// Input: level 1..3
+// Output: set point in F (20, 30 or 40)
+extern unsigned char Settings_LevelToTemp(unsigned char level);
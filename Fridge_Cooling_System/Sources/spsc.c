@@ -0,0 +1,60 @@
+// filename  ***************  spsc.c  *****************************
+// Lock-free single-producer/single-consumer queue (see spsc.h)
+
+#include "spsc.h"
+
+//-------------------------Spsc_Reset-------------------------
+// Empties the ring and clears the drop count, only while neither side runs
+// Input: queue
+// Output: none
+void Spsc_Reset(Spsc *q) {
+  q->head = q->tail = 0;
+  q->dropped = 0;
+}
+
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+//-------------------------Spsc_Put---------------------------
+// Appends a copy of one element (producer side)
+// Input: queue, element
+// Output: TRUE if queued, FALSE if the ring was full (counted as dropped)
+char Spsc_Put(Spsc *q, const void *item) {
+  unsigned char head = q->head;
+  unsigned char n = q->width;
+  const unsigned char *src = item;
+  volatile unsigned char *dst;
+
+  if ((unsigned char)(head - q->tail) > q->mask) {
+    if (q->dropped != 0xFF) {
+      q->dropped++;
+    }
+    return 0;
+  }
+  dst = q->buf + (unsigned short)(head & q->mask) * n;
+  while (n--) {
+    *dst++ = *src++;
+  }
+  q->head = head + 1;   // publish, the element is complete
+  return 1;
+}
+
+//-------------------------Spsc_Get---------------------------
+// Removes the oldest element (consumer side)
+// Input: queue, where to copy the element
+// Output: TRUE if an element was returned, FALSE if the ring is empty
+char Spsc_Get(Spsc *q, void *item) {
+  unsigned char tail = q->tail;
+  unsigned char n = q->width;
+  const volatile unsigned char *src;
+  unsigned char *dst = item;
+
+  if (tail == q->head) {
+    return 0;
+  }
+  src = q->buf + (unsigned short)(tail & q->mask) * n;
+  while (n--) {
+    *dst++ = *src++;
+  }
+  q->tail = tail + 1;   // release, the slot may be overwritten now
+  return 1;
+}
+#pragma CODE_SEG DEFAULT
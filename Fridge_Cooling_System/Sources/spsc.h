@@ -0,0 +1,69 @@
+// filename  ***************  spsc.h  *****************************
+// Lock-free single-producer/single-consumer queue
+//
+// A ring of fixed-size elements between exactly one producer and one
+// consumer, an interrupt handler and the main loop. Neither side masks
+// interrupts: head is only written by the producer, tail only by the
+// consumer, and both are 8-bit free-running counters, so each is loaded
+// and stored by a single instruction and can't be seen half-written.
+// The producer stores the element before it publishes it with head, the
+// consumer copies it out before it hands the slot back with tail. The
+// HCS12 does not reorder memory accesses, and the ring and both counters
+// are volatile so the compiler keeps that order too.
+//
+// Sizes are powers of 2 up to 128, so head - tail is the fill level even
+// after the counters wrap; SPSC_DEFINE rejects other sizes at compile time.
+//
+//   SPSC_DEFINE(keys, unsigned char, 8);   // static ring and descriptor
+//   Spsc_Put(&keys, &k);                   // producer only
+//   Spsc_Get(&keys, &k);                   // consumer only
+
+typedef struct _spsc
+{
+   volatile unsigned char head;    // elements put, written by the producer only
+   volatile unsigned char tail;    // elements taken, written by the consumer only
+   volatile unsigned char dropped; // puts refused while full, producer only, saturates
+   unsigned char mask;             // size - 1
+   unsigned char width;            // element size in bytes
+   volatile unsigned char *buf;    // elements, volatile so stores stay before head
+} Spsc;
+
+// Defines a static ring of size elements of type and its descriptor
+#define SPSC_DEFINE(name, type, size) \
+  typedef char name##_size_check[((size) & ((size) - 1)) == 0 && (size) <= 128 ? 1 : -1]; \
+  static type name##_buf[size]; \
+  static Spsc name = { 0, 0, 0, (size) - 1, sizeof(type), (volatile unsigned char *)name##_buf }
+
+//-------------------------Spsc_Reset-------------------------
+// Empties the ring and clears the drop count, only while neither side runs
+// Input: queue
+// Output: none
+extern void Spsc_Reset(Spsc *q);
+
+//-------------------------Spsc_Put---------------------------
+// Appends a copy of one element (producer side)
+// Input: queue, element
+// Output: TRUE if queued, FALSE if the ring was full (counted as dropped)
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+extern char Spsc_Put(Spsc *q, const void *item);
+#pragma CODE_SEG DEFAULT
+
+//-------------------------Spsc_Get---------------------------
+// Removes the oldest element (consumer side)
+// Input: queue, where to copy the element
+// Output: TRUE if an element was returned, FALSE if the ring is empty
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+extern char Spsc_Get(Spsc *q, void *item);
+#pragma CODE_SEG DEFAULT
+
+//-------------------------Spsc_Count-------------------------
+// Elements waiting; exact for the consumer, a lower bound for the producer
+// Input: queue
+// Output: 0..size
+#define Spsc_Count(q)   ((unsigned char)((q)->head - (q)->tail))
+
+//-------------------------Spsc_Dropped-----------------------
+// Elements lost because the ring was full
+// Input: queue
+// Output: 8-bit drop count (saturates at 255)
+#define Spsc_Dropped(q) ((q)->dropped)
@@ -0,0 +1,165 @@
+// filename  ***************  stackmon.c  *************************
+// Stack watermarking and usage reporting
+
+#include <hidef.h>
+#include "stackmon.h"
+#include "sci1.h"
+
+
+__SEG_START_DEF(SSTACK);   // lowest stack address, defined by the linker
+__SEG_END_DEF(SSTACK);     // one past the highest stack address
+
+#define STACK_BOTTOM  ((unsigned char *)__SEG_START_REF(SSTACK))
+#define STACK_TOP     ((unsigned char *)__SEG_END_REF(SSTACK))
+
+static unsigned short entry[STACK_ISR_COUNT];  // deepest stack at each ISR's entry
+static unsigned short peak[STACK_ISR_COUNT];   // most each ISR used itself
+
+#ifdef STACK_ISR_PEAKS
+// ISRs don't nest, one window at a time
+static unsigned char *top;      // StackMon_Enter's stack pointer
+static unsigned char *window;   // lowest byte painted for the running ISR
+static unsigned char *lowMark;  // deepest byte found used when painting, 0 = none
+#endif
+
+static char * const isrName[STACK_ISR_COUNT] = {
+  "MDCU", "TIMCH0", "TIMCH6", "TIMCH7", "IRQ", "EEPROM", "SCI1", "RTI"
+};
+
+
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+//-------------------------StackMon_Enter----------------------
+// Records the current stack depth for an ISR and paints the window below
+// it, call first thing in the ISR
+// Input: STACK_ISR_xxx
+// Output: none
+void StackMon_Enter(unsigned char isr) {
+  unsigned char here;   // its address is the stack pointer, give or take a few bytes
+  unsigned short used = (unsigned short)(STACK_TOP - &here);
+#ifdef STACK_ISR_PEAKS
+  unsigned char *p, *base;
+#endif
+
+  if (used > entry[isr]) {
+    entry[isr] = used;
+  }
+#ifdef STACK_ISR_PEAKS
+  top = &here;
+  base = top - STACK_SLACK;
+  window = base - peak[isr] - STACK_WINDOW;
+  if (window < STACK_BOTTOM + STACK_GUARD) {
+    window = STACK_BOTTOM + STACK_GUARD;
+  }
+  if (window > base) {
+    window = base;   // already in the red zone, nothing to paint
+  }
+  for (p = window; p < base && *p == STACK_PAINT; p++) {}
+  if (p < base && (lowMark == 0 || p < lowMark)) {
+    lowMark = p;   // earlier use about to be painted over
+  }
+  for (p = window; p < base; p++) {
+    *p = STACK_PAINT;
+  }
+#endif
+}
+
+//-------------------------StackMon_Exit-----------------------
+// Records the ISR's own peak from the window, call last thing in the ISR
+// Input: STACK_ISR_xxx, as given to StackMon_Enter
+// Output: none
+void StackMon_Exit(unsigned char isr) {
+#ifdef STACK_ISR_PEAKS
+  unsigned char *p;
+  unsigned short used;
+
+  for (p = window; p < top - STACK_SLACK && *p == STACK_PAINT; p++) {}
+  used = (unsigned short)(top - p);
+  if (used > peak[isr]) {
+    peak[isr] = used;
+  }
+#else
+  (void)isr;
+#endif
+}
+#pragma CODE_SEG DEFAULT
+
+//-------------------------StackMon_Size-----------------------
+// Size of the SSTACK segment (STACKSIZE in Project.prm)
+// Input: none
+// Output: bytes
+unsigned short StackMon_Size(void) {
+  return (unsigned short)(STACK_TOP - STACK_BOTTOM);
+}
+
+//-------------------------StackMon_HighWater------------------
+// Deepest stack use since reset, from the paint pattern
+// Input: none
+// Output: bytes used at the deepest point
+unsigned short StackMon_HighWater(void) {
+  unsigned char *p = STACK_BOTTOM;
+
+  while (p < STACK_TOP && *p == STACK_PAINT) {
+    p++;
+  }
+#ifdef STACK_ISR_PEAKS
+  if (lowMark != 0 && lowMark < p) {
+    p = lowMark;   // repainted by StackMon_Enter since
+  }
+#endif
+  return (unsigned short)(STACK_TOP - p);
+}
+
+//-------------------------StackMon_Entry----------------------
+// Deepest stack seen at the entry of an ISR
+// Input: STACK_ISR_xxx
+// Output: bytes in use when the ISR started (0 = never ran)
+unsigned short StackMon_Entry(unsigned char isr) {
+  return entry[isr];
+}
+
+//-------------------------StackMon_Peak-----------------------
+// Most stack an ISR used itself, from its entry to its exit
+// Input: STACK_ISR_xxx
+// Output: bytes below the entry depth (0 = never exited, or no
+//         STACK_ISR_PEAKS)
+unsigned short StackMon_Peak(unsigned char isr) {
+  return peak[isr];
+}
+
+//-------------------------StackMon_Overflow-------------------
+// Checks the red zone at the bottom of the stack
+// Input: none
+// Output: TRUE if the stack reached the last STACK_GUARD bytes
+char StackMon_Overflow(void) {
+  unsigned char i;
+
+  for (i = 0; i < STACK_GUARD; i++) {
+    if (STACK_BOTTOM[i] != STACK_PAINT) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+//-------------------------StackMon_Report---------------------
+// Prints size, high-water mark and per-ISR entry depths and peaks over SCI1
+// Input: none
+// Output: none
+void StackMon_Report(void) {
+  unsigned char i;
+
+  SCI1_OutString("Stack size ");SCI1_OutUDec(StackMon_Size());
+  SCI1_OutString(", high water ");SCI1_OutUDec(StackMon_HighWater());
+  if (StackMon_Overflow()) {
+    SCI1_OutString(" OVERFLOW");
+  }
+  SCI1_OutChar(CR);SCI1_OutChar(LF);
+  for (i = 0; i < STACK_ISR_COUNT; i++) {
+    SCI1_OutString("  ");SCI1_OutString(isrName[i]);
+    SCI1_OutString(" entry depth ");SCI1_OutUDec(entry[i]);
+#ifdef STACK_ISR_PEAKS
+    SCI1_OutString(", own peak ");SCI1_OutUDec(peak[i]);
+#endif
+    SCI1_OutChar(CR);SCI1_OutChar(LF);
+  }
+}
@@ -0,0 +1,88 @@
+// filename  ***************  stackmon.h  *************************
+// Stack watermarking and usage reporting
+//
+// Start12.c paints the SSTACK segment with STACK_PAINT_WORD at reset
+// (_DO_PAINT_STACK_). The high-water mark is the lowest byte that no longer
+// holds the pattern. Each ISR also records the stack depth at its entry,
+// how deep the interrupted code was, and with STACK_ISR_PEAKS its own peak:
+// StackMon_Enter repaints a window below the entry depth, StackMon_Exit
+// finds the lowest byte the ISR wrote there. The window is the ISR's peak
+// so far plus STACK_WINDOW, so it grows until the peak fits. The entry
+// depth plus the ISR's peak bounds the stack with that ISR active.
+// The lowest STACK_GUARD bytes act as a red zone: once any of them is
+// touched the stack is about to run into the variables below it. They
+// are never repainted, and repainting a window keeps the high-water mark.
+
+#define STACK_PAINT_WORD  0xA5A5
+#define STACK_PAINT       0xA5
+#define STACK_GUARD       16      // red zone at the bottom of SSTACK
+#define STACK_WINDOW      32      // painted below an ISR's entry beyond its peak so far
+#define STACK_SLACK       8       // StackMon_Enter/Exit's own locals, not painted
+
+// A release build (RELEASE defined) records the entry depths only
+#ifndef RELEASE
+#define STACK_ISR_PEAKS
+#endif
+
+// ISRs with a depth probe, index into the per-ISR peak table
+#define STACK_ISR_MDCU    0
+#define STACK_ISR_TIMCH0  1
+#define STACK_ISR_TIMCH6  2
+#define STACK_ISR_TIMCH7  3
+#define STACK_ISR_IRQ     4
+#define STACK_ISR_EEPROM  5
+#define STACK_ISR_SCI1    6
+#define STACK_ISR_RTI     7
+#define STACK_ISR_COUNT   8
+
+//-------------------------StackMon_Enter----------------------
+// Records the current stack depth for an ISR and paints the window below
+// it, call first thing in the ISR
+// Input: STACK_ISR_xxx
+// Output: none
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+extern void StackMon_Enter(unsigned char isr);
+
+//-------------------------StackMon_Exit-----------------------
+// Records the ISR's own peak from the window, call last thing in the ISR
+// Input: STACK_ISR_xxx, as given to StackMon_Enter
+// Output: none
+extern void StackMon_Exit(unsigned char isr);
+#pragma CODE_SEG DEFAULT
+
+//-------------------------StackMon_Size-----------------------
+// Size of the SSTACK segment (STACKSIZE in Project.prm)
+// Input: none
+// Output: bytes
+extern unsigned short StackMon_Size(void);
+
+//-------------------------StackMon_HighWater------------------
+// Deepest stack use since reset, from the paint pattern
+// Input: none
+// Output: bytes used at the deepest point
+extern unsigned short StackMon_HighWater(void);
+
+//-------------------------StackMon_Entry----------------------
+// Deepest stack seen at the entry of an ISR
+// Input: STACK_ISR_xxx
+// Output: bytes in use when the ISR started (0 = never ran)
+extern unsigned short StackMon_Entry(unsigned char isr);
+
+//-------------------------StackMon_Peak-----------------------
+// Most stack an ISR used itself, from its entry to its exit
+// Input: STACK_ISR_xxx
+// Output: bytes below the entry depth (0 = never exited, or no
+//         STACK_ISR_PEAKS)
+extern unsigned short StackMon_Peak(unsigned char isr);
+
+//-------------------------StackMon_Overflow-------------------
+// Checks the red zone at the bottom of the stack
+// Input: none
+// Output: TRUE if the stack reached the last STACK_GUARD bytes
+extern char StackMon_Overflow(void);
+
+//-------------------------StackMon_Report---------------------
+// Prints size, high-water mark and per-ISR entry depths and peaks over SCI1
+// Input: none
+// Output: none
+extern void StackMon_Report(void);
@@ -0,0 +1,51 @@
+// filename  ***************  state.c  ****************************
+// Double-buffered system state (see state.h)
+
+#include "state.h"
+
+static SysState copies[2];
+static volatile unsigned char live;   // index of the live copy, written by State_Publish only
+
+//-------------------------State_Init-------------------------
+// Clears both copies, only while no ISR can read them
+// Input: none
+// Output: none
+void State_Init(void) {
+  unsigned char i, *p = (unsigned char *)copies;
+
+  for (i = 0; i < sizeof(copies); i++) {
+    p[i] = 0;
+  }
+  live = 0;
+}
+
+//-------------------------State_Now--------------------------
+// Live snapshot, consistent until the caller's next State_Publish (main
+// loop) or until the ISR returns
+// Input: none
+// Output: read-only pointer to the live copy
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+const SysState *State_Now(void) {
+  return &copies[live];
+}
+#pragma CODE_SEG DEFAULT
+
+//-------------------------State_Edit-------------------------
+// Copies the live snapshot into the spare copy, main loop only
+// Input: none
+// Output: spare copy to modify, call State_Publish when done
+SysState *State_Edit(void) {
+  copies[live ^ 1] = copies[live];   // the ISRs only read copies[live]
+  return &copies[live ^ 1];
+}
+
+//-------------------------State_Publish----------------------
+// Makes the copy returned by State_Edit live and bumps its version
+// Input: none
+// Output: none
+void State_Publish(void) {
+  unsigned char spare = live ^ 1;
+
+  copies[spare].version = copies[live].version + 1;
+  live = spare;   // single byte store, ISRs see the old or the new copy
+}
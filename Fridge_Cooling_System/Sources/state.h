@@ -0,0 +1,52 @@
+// filename  ***************  state.h  ****************************
+// Double-buffered system state, written by main() and read by the ISRs
+//
+// The zone settings, the current temperature and the started flag are
+// only ever written from the main loop. Two copies are kept: the writer
+// fills the spare copy (State_Edit) and makes it live with one byte store
+// (State_Publish). A reader takes the live copy (State_Now). An ISR can't
+// be interrupted by the writer, so the copy it holds doesn't change until
+// it returns, and the main loop only reads what it published itself.
+// Both sides run in constant time with interrupts enabled, and no field,
+// however wide, can be seen half-updated.
+//
+// Flags the ISRs write (is_ref_on, f1_level, f2_level) stay single bytes in
+// control.c; a second writer would break the scheme.
+
+typedef struct _sysState
+{
+   unsigned short version;        // publications since State_Init
+   unsigned char num_of_zones;    // 1 or 2, 0 until the settings are known
+   unsigned char temp1, temp2;    // zones 1 and 2 temperature levels
+   unsigned char temp1_spec;      // zone 1 temperature (F)
+   unsigned char temp2_spec;      // zone 2 temperature (F)
+   unsigned char cur_temp;        // current temperature (F)
+   unsigned char ref_has_started; // power switch seen on since main() started
+} SysState;
+
+//-------------------------State_Init-------------------------
+// Clears both copies, only while no ISR can read them
+// Input: none
+// Output: none
+extern void State_Init(void);
+
+//-------------------------State_Now--------------------------
+// Live snapshot, consistent until the caller's next State_Publish (main
+// loop) or until the ISR returns
+// Input: none
+// Output: read-only pointer to the live copy
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+extern const SysState *State_Now(void);
+#pragma CODE_SEG DEFAULT
+
+//-------------------------State_Edit-------------------------
+// Copies the live snapshot into the spare copy, main loop only
+// Input: none
+// Output: spare copy to modify, call State_Publish when done
+extern SysState *State_Edit(void);
+
+//-------------------------State_Publish----------------------
+// Makes the copy returned by State_Edit live and bumps its version
+// Input: none
+// Output: none
+extern void State_Publish(void);
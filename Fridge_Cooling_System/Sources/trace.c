@@ -0,0 +1,109 @@
+// filename  ***************  trace.c  ****************************
+// RAM ring of timestamped firmware events (see trace.h)
+
+#include "hal.h"
+#include "trace.h"
+#include "sci1.h"
+
+#define TRACE_MASK    (TRACE_SIZE - 1)
+
+typedef struct _traceEntry {
+  unsigned short time;  // TCNT
+  unsigned char id;
+  unsigned short arg;
+} TraceEntry;
+
+#ifdef TRACE_EVENTS
+static TraceEntry ring[TRACE_SIZE];
+static unsigned char head;      // next slot
+static unsigned char wrapped;   // head went around at least once
+static unsigned char frozen;
+#endif
+
+
+//-------------------------Trace_Event------------------------
+// Records one event with the current TCNT, unless frozen
+// Input: kind | event, argument
+// Output: none
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+void Trace_Event(unsigned char id, unsigned short arg) {
+#ifdef TRACE_EVENTS
+  TraceEntry *e;
+  unsigned char ccr;
+
+  HAL_CRITICAL_ENTER(ccr);
+  if (!frozen) {
+    e = &ring[head];
+    e->time = HAL_TCNT();
+    e->id = id;
+    e->arg = arg;
+    head = (head + 1) & TRACE_MASK;
+    if (head == 0) {
+      wrapped = 1;
+    }
+  }
+  HAL_CRITICAL_EXIT(ccr);
+#endif
+}
+
+//-------------------------Trace_Freeze-----------------------
+// Records a fault and stops recording until the next dump
+// Input: LOG_FAULT_xxx
+// Output: none
+void Trace_Freeze(unsigned char fault) {
+#ifdef TRACE_EVENTS
+  Trace_Event(TRACE_MARK | TRACE_FAULT, fault);
+  frozen = 1;
+#endif
+}
+#pragma CODE_SEG DEFAULT
+
+//-------------------------Trace_Dump-------------------------
+// Sends the ring over SCI1 as one binary frame, then resumes recording
+// Text output is muted while the frame is sent.
+// Input: none
+// Output: none
+void Trace_Dump(void) {
+#ifdef TRACE_EVENTS
+  TraceEntry e;
+  unsigned short n, i;
+  unsigned char first, sum, flags, ccr;
+  unsigned char bytes[5];
+  unsigned char b;
+
+  HAL_CRITICAL_ENTER(ccr);
+  flags = (frozen ? TRACE_FROZEN : 0) | (wrapped ? TRACE_WRAPPED : 0);
+  frozen = 1;   // hold the ring still while it is sent
+  HAL_CRITICAL_EXIT(ccr);
+  n = wrapped ? TRACE_SIZE : head;
+  first = wrapped ? head : 0;   // oldest entry
+
+  SCI1_Mute(1);
+  SCI1_OutByte('T');
+  SCI1_OutByte('R');
+  SCI1_OutByte(flags);
+  SCI1_OutByte(n >> 8);
+  SCI1_OutByte(n & 0xFF);
+  sum = 0;
+  for (i = 0; i < n; i++) {
+    e = ring[(first + i) & TRACE_MASK];
+    bytes[0] = e.time >> 8;
+    bytes[1] = e.time & 0xFF;
+    bytes[2] = e.id;
+    bytes[3] = e.arg >> 8;
+    bytes[4] = e.arg & 0xFF;
+    for (b = 0; b < 5; b++) {
+      SCI1_OutByte(bytes[b]);
+      sum += bytes[b];
+    }
+  }
+  SCI1_OutByte(sum);
+  SCI1_Mute(0);
+
+  HAL_CRITICAL_ENTER(ccr);
+  head = 0;
+  wrapped = 0;
+  frozen = 0;
+  HAL_CRITICAL_EXIT(ccr);
+#endif
+}
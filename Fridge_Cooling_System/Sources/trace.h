@@ -0,0 +1,69 @@
+// filename  ***************  trace.h  ****************************
+// RAM ring of timestamped firmware events
+//
+// TRACE(id, arg) stores TCNT, an event id and a 16-bit argument in a
+// ring of TRACE_SIZE entries; the oldest entries are overwritten. ISRs
+// and the main loop both record, the slot is claimed with interrupts
+// masked for a few instructions. Trace_Freeze stops recording at a fault
+// so the events leading up to it survive the main() restart; the 'T'
+// command dumps the ring (Trace_Dump) and resumes recording.
+// tools/trace2chrome.py turns a dump into a Chrome trace (about:tracing,
+// Perfetto) timeline.
+//
+// Event id: [7:6] kind, [5:0] event
+//   TRACE_BEGIN/TRACE_END bracket a span (an ISR), TRACE_MARK is an instant
+//
+// Dump frame: 'T' 'R' flags count_hi count_lo entries... sum
+//   entry: time_hi time_lo id arg_hi arg_lo, oldest first
+//   flags bit 0: frozen, bit 1: the ring wrapped, older entries are lost
+//   sum: 8-bit sum of the entry bytes
+
+#define TRACE_EVENTS        // remove to compile the trace out
+
+#define TRACE_SIZE    256   // entries, power of 2 up to 256, 5 bytes of RAM each
+
+// Event kinds
+#define TRACE_MARK    0x00
+#define TRACE_BEGIN   0x40
+#define TRACE_END     0x80
+
+// Events (names in tools/trace2chrome.py)
+#define TRACE_CONTROL 1     // control law in the system tick, end arg: f1_level << 8 | f2_level
+#define TRACE_FAN1    2     // zone 1 fan compare, arg: compare value (end: the next one)
+#define TRACE_FAN2    3     // zone 2 fan or FAN_OC7_MASTER period compare, arg: compare value (end: the next one)
+#define TRACE_TICK    4     // port H sampling tick, arg: compare value (end: the next one)
+#define TRACE_STOP    5     // IRQ stop switch
+#define TRACE_LOOP    6     // main loop pass, arg: cur_temp
+#define TRACE_DOOR    7     // door switch change, arg: 1 open, 0 closed
+#define TRACE_CMD     8     // SCI command, arg: command character
+#define TRACE_FAULT   9     // fault that froze the trace, arg: LOG_FAULT_xxx
+
+#define TRACE_FROZEN  0x01  // dump flags
+#define TRACE_WRAPPED 0x02
+
+#ifdef TRACE_EVENTS
+#define TRACE(id, arg)  Trace_Event(id, arg)
+#else
+#define TRACE(id, arg)
+#endif
+
+//-------------------------Trace_Event------------------------
+// Records one event with the current TCNT, unless frozen
+// Input: kind | event, argument
+// Output: none
+#pragma CODE_SEG __NEAR_SEG ISR_CODE
+extern void Trace_Event(unsigned char id, unsigned short arg);
+
+//-------------------------Trace_Freeze-----------------------
+// Records a fault and stops recording until the next dump
+// Input: LOG_FAULT_xxx
+// Output: none
+extern void Trace_Freeze(unsigned char fault);
+#pragma CODE_SEG DEFAULT
+
+//-------------------------Trace_Dump-------------------------
+// Sends the ring over SCI1 as one binary frame, then resumes recording
+// Text output is muted while the frame is sent.
+// Input: none
+// Output: none
+extern void Trace_Dump(void);
@@ -0,0 +1,54 @@
+// filename  ***************  eeprom_host.c  **********************
+// eeprom.h for the host build: the 4 KB array is plain RAM that keeps
+// its contents across HalHost_PowerOn(), writes land immediately.
+
+#include <string.h>
+#include "hal.h"
+#include "eeprom.h"
+
+unsigned char eeHostArray[0x1000];
+static unsigned char eeHostErased;
+
+//-------------------------EEPROM_HostErase-------------------
+// Sets every byte to 0xFF, as a new part
+// Input: none
+// Output: none
+void EEPROM_HostErase(void) {
+  memset(eeHostArray, 0xFF, sizeof(eeHostArray));
+  eeHostErased = 1;
+}
+
+void EEPROM_Init(void) {
+  if (!eeHostErased) {
+    EEPROM_HostErase();
+  }
+}
+
+void EEPROM_Read(unsigned short addr, void *dst, unsigned short len) {
+  memcpy(dst, &eeHostArray[addr & 0x0FFF], len);
+}
+
+char EEPROM_Write(unsigned short addr, const void *src, unsigned short len) {
+  if (addr < EE_START || (unsigned long)addr + len > EE_END + 1UL) {
+    return 0;
+  }
+  memcpy(&eeHostArray[addr], src, len);
+  return 1;
+}
+
+void EEPROM_Flush(void) {
+}
+
+void EEPROM_Sync(void) {
+}
+
+char EEPROM_Busy(void) {
+  return 0;
+}
+
+unsigned char EEPROM_Errors(void) {
+  return 0;
+}
+
+void EEPROM_Service(void) {
+}
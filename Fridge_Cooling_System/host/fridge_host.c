@@ -0,0 +1,188 @@
+// filename  ***************  fridge_host.c  **********************
+// Runs the fridge control application (Sources/control.c) on the host
+// register model for a given simulated time
+//
+// Usage: fridge_host [-t seconds] [-k keys] [-d dip] [-a atd] [-i stop_s] [-q]
+//                    [-O log] [-r trace] [-T trace]
+//   -t  simulated seconds, default 10
+//   -k  keypad input, one hex digit per key, pressed 2.5 s apart
+//       starting at 1.5 s, default "212" (2 zones, levels 1 and 2)
+//   -d  DIP switches (PTH), default 0x4C: power on, 26 F
+//   -a  temperature sensor reading (ATD channel 5), default 10
+//   -i  presses the IRQ stop switch at this simulated second
+//   -q  counts the SCI output instead of printing it
+//   -O  output log (outlog.h) to this file, SCI text included
+//   -r  at the end, writes the input recording (the 'R' dump) to this
+//       file for fridge_replay
+//   -T  at the end, writes the event trace (the 'T' dump) to this file
+//       for tools/trace2chrome.py
+// Prints the LCD, interrupt counts, the shortest and longest fan PWM
+// period and the simulated/wall time ratio to stderr at the end.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "hal.h"
+#include "control.h"
+#include "outlog.h"
+#include "trace.h"
+#include "sci1.h"
+#include "rtc.h"
+#include "fan.h"
+
+#define ENV_PERIOD    (HAL_HOST_BUS_HZ / 1000)   // environment runs every 1 ms
+#define KEY_FIRST_MS  1500
+#define KEY_EVERY_MS  2500
+#define KEY_HOLD_MS   100
+
+// Keypad position (row * 4 + column) of each key code key_pad() returns
+static const char keyCodes[] = "147E2580369FABCD";
+
+static const char *keys = "212";
+static unsigned long long endCycles;
+static unsigned long long irqCycles;
+static jmp_buf done;
+static FILE *logFile, *recFile, *traceFile;
+
+static void quiet(byte c) {
+  (void)c;
+}
+
+static void toRecFile(byte c) {
+  fputc(c, recFile);
+}
+
+static void toTraceFile(byte c) {
+  fputc(c, traceFile);
+}
+
+// Keypad script, stop switch and the end of the run
+static void environment(void) {
+  unsigned long ms = (unsigned long)(halHost.cycles / ENV_PERIOD);
+  unsigned long i;
+  const char *pos;
+
+  halHost.key = HAL_HOST_NO_KEY;
+  if (ms >= KEY_FIRST_MS) {
+    i = (ms - KEY_FIRST_MS) / KEY_EVERY_MS;
+    if (i < strlen(keys) && (ms - KEY_FIRST_MS) % KEY_EVERY_MS < KEY_HOLD_MS) {
+      pos = strchr(keyCodes, keys[i]);
+      if (pos) {
+        halHost.key = (byte)(pos - keyCodes);
+      }
+    }
+  }
+  if (logFile && halHost.cycles % OUTLOG_PERIOD == 0) {
+    OutLog_Sample();
+  }
+  if (irqCycles && halHost.cycles >= irqCycles) {
+    irqCycles = 0;
+    HalHost_Irq();
+  }
+  if (halHost.cycles >= endCycles) {
+    longjmp(done, 1);
+  }
+}
+
+int main(int argc, char **argv) {
+  double seconds = 10.0, wall;
+  unsigned int dip = 0x4C, atd = 10;
+  int opt, quietSci = 0;
+  clock_t start;
+
+  while ((opt = getopt(argc, argv, "t:k:d:a:i:qO:r:T:")) != -1) {
+    switch (opt) {
+      case 't': seconds = atof(optarg); break;
+      case 'k': keys = optarg; break;
+      case 'd': dip = (unsigned int)strtoul(optarg, NULL, 0); break;
+      case 'a': atd = (unsigned int)strtoul(optarg, NULL, 0); break;
+      case 'i': irqCycles = (unsigned long long)(atof(optarg) * HAL_HOST_BUS_HZ); break;
+      case 'q': quietSci = 1; break;
+      case 'O':
+        logFile = fopen(optarg, "w");
+        if (!logFile) {
+          perror(optarg);
+          return 1;
+        }
+        break;
+      case 'r':
+        recFile = fopen(optarg, "wb");
+        if (!recFile) {
+          perror(optarg);
+          return 1;
+        }
+        break;
+      case 'T':
+        traceFile = fopen(optarg, "wb");
+        if (!traceFile) {
+          perror(optarg);
+          return 1;
+        }
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-t seconds] [-k keys] [-d dip] [-a atd] [-i stop_s] [-q]\n"
+                        "          [-O log] [-r trace] [-T trace]\n", argv[0]);
+        return 2;
+    }
+  }
+
+  HalHost_PowerOn();
+  halHost.pth = (byte)dip;
+  halHost.atd[5] = (byte)atd;
+  if (quietSci) {
+    halHost.sciTx = quiet;
+  }
+  if (logFile) {
+    OutLog_Open(logFile);
+  }
+  HalHost_SetVector(HAL_VEC_IRQ, Control_Stop);
+  HalHost_SetVector(HAL_VEC_TIMCH0, Control_Fan1);
+  HalHost_SetVector(HAL_VEC_TIMCH6, Control_InputTick);
+  HalHost_SetVector(HAL_VEC_TIMCH7, Control_Fan2);
+  HalHost_SetVector(HAL_VEC_MDCU, Control_Tick);
+  HalHost_SetVector(HAL_VEC_RTI, RTC_Tick);
+  HalHost_SetVector(HAL_VEC_SCI1, SCI1_RxService);
+  endCycles = (unsigned long long)(seconds * HAL_HOST_BUS_HZ);
+  HalHost_SetEnvironment(environment, ENV_PERIOD);
+
+  start = clock();
+  if (setjmp(done) == 0) {
+    setjmp(halHostRestart);   // HAL_RESTART() comes back here
+    Control_Main();
+  }
+  wall = (double)(clock() - start) / CLOCKS_PER_SEC;
+  if (logFile) {
+    fclose(logFile);
+  }
+  halHost.sciTxCycles = 0;   // the dumps below are not part of the run
+  if (recFile) {
+    halHost.sciTx = toRecFile;
+    REC_Dump();
+    fclose(recFile);
+  }
+  if (traceFile) {
+    halHost.sciTx = toTraceFile;
+    Trace_Dump();
+    fclose(traceFile);
+  }
+
+  fflush(stdout);
+  fprintf(stderr, "\nLCD  |%-16s|\n     |%-16s|\n", HalHost_LcdLine(1), HalHost_LcdLine(2));
+  fprintf(stderr, "PT%u %u PT%u %u  PORTB %02X  SCI %lu bytes\n", FAN_CH1, HalHost_OcPin(FAN_CH1),
+          FAN_CH2, HalHost_OcPin(FAN_CH2), halHost.portb, halHost.sciTxCount);
+  fprintf(stderr, "interrupts: IRQ %lu  TC0 %lu  TC6 %lu  TC7 %lu  MDCU %lu\n",
+          halHost.isrCount[HAL_VEC_IRQ], halHost.isrCount[HAL_VEC_TIMCH0],
+          halHost.isrCount[HAL_VEC_TIMCH6], halHost.isrCount[HAL_VEC_TIMCH7],
+          halHost.isrCount[HAL_VEC_MDCU]);
+  fprintf(stderr, "fan PWM period us: PT%u %lu..%lu  PT%u %lu..%lu, forced edges %lu %lu\n",
+          FAN_CH1, halHost.ptPeriodMin[FAN_CH1] / (HAL_HOST_BUS_HZ / 1000000),
+          halHost.ptPeriodMax[FAN_CH1] / (HAL_HOST_BUS_HZ / 1000000),
+          FAN_CH2, halHost.ptPeriodMin[FAN_CH2] / (HAL_HOST_BUS_HZ / 1000000),
+          halHost.ptPeriodMax[FAN_CH2] / (HAL_HOST_BUS_HZ / 1000000),
+          halHost.ptForced[FAN_CH1], halHost.ptForced[FAN_CH2]);
+  fprintf(stderr, "%.1f s simulated in %.3f s (%.0fx real time)\n",
+          seconds, wall, wall > 0 ? seconds / wall : 0.0);
+  return 0;
+}
@@ -0,0 +1,265 @@
+// filename  ***************  fridge_replay.c  ********************
+// Replays an input recording (Sources/rec.h) through the host HAL
+//
+// The trace is the 'R' dump, as captured from the target's SCI or written
+// by fridge_host -r; anything around the frame is skipped. Every input
+// starts at its first recorded value, then each change is put on the
+// model's pins at the timer tick it was read on the target, so the
+// application takes the same path. The outputs (fan duty, LCD, SCI text)
+// are written in the outlog.h format and can be diffed against the log
+// of the recorded run.
+//
+// The EEPROM starts erased unless -l stores zone settings, as they were
+// on the target at power-on. The IRQ stop switch is not recorded.
+//
+// Usage: fridge_replay [-t seconds] [-l levels] [-o log] [-d reference] trace
+//   -t  simulated seconds, default 2 s after the last recorded input
+//   -l  keypad temperature level per zone stored before power-on, "12"
+//   -o  output log file, default stdout
+//   -d  compares the output log with this one, exit status 1 if they differ
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "hal.h"
+#include "control.h"
+#include "eeprom.h"
+#include "settings.h"
+#include "outlog.h"
+#include "sci1.h"
+#include "rtc.h"
+
+#define POLL_CYCLES   (HAL_HOST_BUS_HZ / 1000)   // until the recorder starts
+#define TAIL_CYCLES   (2ULL * HAL_HOST_BUS_HZ)    // run on after the last input
+
+typedef struct _recEvent {
+  unsigned long t;        // ticks since REC_Init
+  unsigned char input;
+  unsigned char v;
+} RecEvent;
+
+static RecEvent *events;
+static long eventCount, nextEvent;
+static unsigned long long endCycles, nextSample;
+static jmp_buf done;
+
+// Finds the first frame with a good checksum and decodes its records
+static int loadTrace(const char *name) {
+  FILE *f = fopen(name, "rb");
+  unsigned char *buf, *rec, sum;
+  long size, i, j, len;
+  unsigned long t, dt;
+  int shift;
+
+  if (!f) {
+    perror(name);
+    return 0;
+  }
+  fseek(f, 0, SEEK_END);
+  size = ftell(f);
+  rewind(f);
+  buf = malloc(size + 1);
+  if (!buf || fread(buf, 1, size, f) != (size_t)size) {
+    fprintf(stderr, "%s: read error\n", name);
+    return 0;
+  }
+  fclose(f);
+
+  for (i = 0; i + 6 <= size; i++) {
+    if (buf[i] != 'R' || buf[i + 1] != 'T') {
+      continue;
+    }
+    len = (buf[i + 3] << 8) | buf[i + 4];
+    if (i + 6 + len > size) {
+      continue;
+    }
+    rec = &buf[i + 5];
+    for (sum = 0, j = 0; j < len; j++) {
+      sum += rec[j];
+    }
+    if (sum != rec[len]) {
+      continue;
+    }
+    if (buf[i + 2] & REC_FULL) {
+      fprintf(stderr, "%s: recorder buffer was full, the replay stops at its end\n", name);
+    }
+    events = malloc((len / 3 + 1) * sizeof(RecEvent));
+    for (t = 0, j = 0; j < len; ) {
+      for (dt = 0, shift = 0; j < len && (rec[j] & 0x80); j++, shift += 7) {
+        dt |= (unsigned long)(rec[j] & 0x7F) << shift;
+      }
+      if (j + 2 >= len) {
+        break;
+      }
+      dt |= (unsigned long)rec[j++] << shift;
+      t += dt;
+      events[eventCount].t = t;
+      events[eventCount].input = rec[j++];
+      events[eventCount].v = rec[j++];
+      if (events[eventCount].input >= REC_COUNT) {
+        fprintf(stderr, "%s: bad input number %u\n", name, events[eventCount].input);
+        return 0;
+      }
+      eventCount++;
+    }
+    free(buf);
+    return 1;
+  }
+  fprintf(stderr, "%s: no recording frame found\n", name);
+  return 0;
+}
+
+// Puts one recorded value on the model's input
+static void apply(const RecEvent *e) {
+  byte row, cols;
+
+  if (e->input == REC_DIP) {
+    halHost.pth = e->v;
+  } else if (e->input < REC_KEYPAD + 4) {
+    row = e->input - REC_KEYPAD;
+    cols = (~e->v >> 4) & 0x0F;
+    if (cols) {
+      halHost.key = (byte)(row * 4 + (cols & 1 ? 0 : cols & 2 ? 1 : cols & 4 ? 2 : 3));
+    } else if (halHost.key != HAL_HOST_NO_KEY && (halHost.key >> 2) == row) {
+      halHost.key = HAL_HOST_NO_KEY;
+    }
+  } else if (e->input < REC_ATD + 8) {
+    halHost.atd[e->input - REC_ATD] = e->v;
+  } else {
+    HalHost_SciInput((const char *)&e->v, 1);
+  }
+}
+
+// Delivers the inputs due, samples the outputs and schedules the next call
+// on the cycle the next input becomes due
+static void environment(void) {
+  unsigned long now = REC_Time(), prescaler;
+  unsigned long long next;
+
+  while (nextEvent < eventCount && events[nextEvent].t <= now) {
+    apply(&events[nextEvent++]);
+    if (nextEvent == eventCount && endCycles == ~0ULL) {
+      endCycles = halHost.cycles + TAIL_CYCLES;
+    }
+  }
+  if (halHost.cycles >= nextSample) {
+    OutLog_Sample();
+    nextSample += OUTLOG_PERIOD;
+  }
+  if (halHost.cycles >= endCycles) {
+    longjmp(done, 1);
+  }
+
+  next = nextSample < endCycles ? nextSample : endCycles;
+  if (halHost.tscr1 & 0x80) {
+    prescaler = 1UL << (halHost.tscr2 & 7);
+    if (now == 0 && halHost.cycles + prescaler < next) {
+      next = halHost.cycles + prescaler;   // until REC_Init, check every tick
+    } else if (nextEvent < eventCount) {
+      unsigned long long due = halHost.cycles +
+        (unsigned long long)(events[nextEvent].t - now) * prescaler - halHost.prescale;
+      if (due < next) {
+        next = due;
+      }
+    }
+  } else if (halHost.cycles + POLL_CYCLES < next) {
+    next = halHost.cycles + POLL_CYCLES;
+  }
+  halHost.envNext = next;
+}
+
+int main(int argc, char **argv) {
+  const char *levels = NULL, *refName = NULL;
+  double seconds = 0.0;
+  FILE *out = stdout, *ref;
+  unsigned char seen[REC_COUNT];
+  long i, diffs;
+  int opt;
+  Settings s;
+
+  while ((opt = getopt(argc, argv, "t:l:o:d:")) != -1) {
+    switch (opt) {
+      case 't': seconds = atof(optarg); break;
+      case 'l': levels = optarg; break;
+      case 'o':
+        out = fopen(optarg, "w+");
+        if (!out) {
+          perror(optarg);
+          return 2;
+        }
+        break;
+      case 'd': refName = optarg; break;
+      default:
+        optind = argc + 1;
+        break;
+    }
+  }
+  if (optind != argc - 1) {
+    fprintf(stderr, "usage: %s [-t seconds] [-l levels] [-o log] [-d reference] trace\n", argv[0]);
+    return 2;
+  }
+  if (!loadTrace(argv[optind])) {
+    return 2;
+  }
+  if (refName && out == stdout) {
+    out = tmpfile();
+  }
+
+  HalHost_PowerOn();
+  EEPROM_HostErase();
+  if (levels) {
+    s.num_of_zones = strlen(levels) > 1 ? 2 : 1;
+    s.temp1 = levels[0] - '0';
+    s.temp2 = s.num_of_zones == 2 ? levels[1] - '0' : 1;
+    if (s.temp1 < 1 || s.temp1 > 3 || s.temp2 < 1 || s.temp2 > 3) {
+      fprintf(stderr, "levels are 1, 2 or 3\n");
+      return 2;
+    }
+    Settings_Save(&s);
+  }
+
+  // Inputs as first read after REC_Init, the SCI queue starts empty
+  memset(seen, 0, sizeof(seen));
+  for (i = 0; i < eventCount; i++) {
+    if (!seen[events[i].input] && events[i].input != REC_SCI_RX) {
+      seen[events[i].input] = 1;
+      apply(&events[i]);
+    }
+  }
+
+  OutLog_Open(out);
+  HalHost_SetVector(HAL_VEC_IRQ, Control_Stop);
+  HalHost_SetVector(HAL_VEC_TIMCH0, Control_Fan1);
+  HalHost_SetVector(HAL_VEC_TIMCH6, Control_InputTick);
+  HalHost_SetVector(HAL_VEC_TIMCH7, Control_Fan2);
+  HalHost_SetVector(HAL_VEC_MDCU, Control_Tick);
+  HalHost_SetVector(HAL_VEC_RTI, RTC_Tick);
+  HalHost_SetVector(HAL_VEC_SCI1, SCI1_RxService);
+  endCycles = seconds > 0.0 ? (unsigned long long)(seconds * HAL_HOST_BUS_HZ) : ~0ULL;
+  nextSample = OUTLOG_PERIOD;
+  HalHost_SetEnvironment(environment, POLL_CYCLES);
+
+  if (setjmp(done) == 0) {
+    setjmp(halHostRestart);   // HAL_RESTART() comes back here
+    Control_Main();
+  }
+  fflush(out);
+
+  fprintf(stderr, "%ld inputs replayed of %ld, %.1f s simulated\n",
+          nextEvent, eventCount, halHost.cycles / (double)HAL_HOST_BUS_HZ);
+  if (refName) {
+    ref = fopen(refName, "r");
+    if (!ref) {
+      perror(refName);
+      return 2;
+    }
+    diffs = OutLog_Diff(out, ref);
+    if (diffs) {
+      fprintf(stderr, "%ld lines differ from %s\n", diffs, refName);
+      return 1;
+    }
+    fprintf(stderr, "output matches %s\n", refName);
+  }
+  return 0;
+}
@@ -0,0 +1,216 @@
+// filename  ***************  fridge_sim.c  ***********************
+// Closed-loop simulator: the firmware's control code (through the host
+// HAL) drives the thermal model of plant.c, much faster than real time
+//
+// The zone settings are stored in the EEPROM before power-on, so the
+// firmware warm boots without the keypad dialog. Every 10 ms of simulated
+// time the fan duty of each zone is measured from its output compare
+// pin, the model is advanced and the sensors are written back: the zone
+// temperature onto the port H switches, the room temperature onto ATD
+// channel 5. Door openings follow a fixed schedule.
+//
+// Usage: fridge_sim [options]
+//   -t hours       simulated time, default 8
+//   -z zones       cabinet zones 1..4, default 2 (the firmware controls 2)
+//   -l levels      keypad temperature level per controlled zone, default "12"
+//   -a F           room temperature, default 75
+//   -D min,s       door opens every min minutes for s seconds, default 60,20
+//                  (0 disables)
+//   -s zone        zone whose temperature the firmware sees, default 1
+//   -c W           cooling power per zone at 100 % duty, default 80
+//   -u W/F         wall conductance per zone, default 1.0
+//   -o file        CSV trace of time, temperatures and duties
+//   -p s           CSV period, default 60
+// Prints per-zone temperature error, duty, the shortest and longest fan
+// PWM period and the energy used.
+
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "hal.h"
+#include "control.h"
+#include "eeprom.h"
+#include "porth.h"
+#include "settings.h"
+#include "plant.h"
+#include "sci1.h"
+#include "rtc.h"
+#include "fan.h"
+
+#define STEP_CYCLES   (HAL_HOST_BUS_HZ / 100)    // plant step 10 ms
+#define STEP_S        0.01
+
+static Plant plant;
+static int sensorZone;
+static double doorPeriod = 3600.0, doorOpen = 20.0;
+static FILE *csv;
+static double csvPeriod = 60.0, csvNext;
+static unsigned long long endCycles, lastHigh[8];
+static volatile int restarts;
+static jmp_buf done;
+
+static void countSci(byte c) {
+  (void)c;
+}
+
+// Fan duties from the pins, one plant step, sensors back into the model
+static void environment(void) {
+  double duty[PLANT_ZONES];
+  int i, pin;
+
+  for (i = 0; i < plant.zones; i++) {
+    pin = plant.zone[i].fanPin;
+    duty[i] = 0.0;
+    if (pin >= 0) {
+      duty[i] = (double)(halHost.ptHigh[pin] - lastHigh[pin]) / STEP_CYCLES;
+      lastHigh[pin] = halHost.ptHigh[pin];
+    }
+  }
+  plant.door = doorPeriod > 0 && (plant.time - doorPeriod * (int)(plant.time / doorPeriod)) >= doorPeriod - doorOpen;
+  Plant_Step(&plant, STEP_S, duty);
+
+  halHost.pth = Plant_SensorDip(plant.zone[sensorZone].temp) | PORTH_POWER_BIT |
+                (plant.door ? PORTH_DOOR_BIT : 0);
+  halHost.atd[5] = Plant_SensorAtd(plant.ambient);
+
+  if (csv && plant.time >= csvNext) {
+    csvNext += csvPeriod;
+    fprintf(csv, "%.0f,%d", plant.time, plant.door);
+    for (i = 0; i < plant.zones; i++) {
+      fprintf(csv, ",%.2f,%.3f", plant.zone[i].temp, duty[i]);
+    }
+    fprintf(csv, "\n");
+  }
+  if (halHost.cycles >= endCycles) {
+    longjmp(done, 1);
+  }
+}
+
+int main(int argc, char **argv) {
+  const char *levels = "12";
+  double hours = 8.0, ambient = 75.0, cool = 80.0, ua = 1.0, wall;
+  int zones = 2, opt, i;
+  Settings s;
+  clock_t start;
+
+  while ((opt = getopt(argc, argv, "t:z:l:a:D:s:c:u:o:p:")) != -1) {
+    switch (opt) {
+      case 't': hours = atof(optarg); break;
+      case 'z': zones = atoi(optarg); break;
+      case 'l': levels = optarg; break;
+      case 'a': ambient = atof(optarg); break;
+      case 'D':
+        doorPeriod = atof(optarg) * 60.0;
+        doorOpen = strchr(optarg, ',') ? atof(strchr(optarg, ',') + 1) : doorOpen;
+        break;
+      case 's': sensorZone = atoi(optarg) - 1; break;
+      case 'c': cool = atof(optarg); break;
+      case 'u': ua = atof(optarg); break;
+      case 'o':
+        csv = fopen(optarg, "w");
+        if (!csv) {
+          perror(optarg);
+          return 1;
+        }
+        break;
+      case 'p': csvPeriod = atof(optarg); break;
+      default:
+        fprintf(stderr, "usage: %s [-t hours] [-z zones] [-l levels] [-a F] [-D min,s] [-s zone]\n"
+                        "          [-c W] [-u W/F] [-o csv] [-p s]\n", argv[0]);
+        return 2;
+    }
+  }
+
+  Plant_Init(&plant, zones);
+  plant.ambient = ambient;
+  for (i = 0; i < plant.zones; i++) {
+    plant.zone[i].temp = plant.zone[i].tMin = plant.zone[i].tMax = ambient;
+    plant.zone[i].coolPower = cool;
+    plant.zone[i].uaWall = ua;
+  }
+  plant.zone[0].fanPin = FAN_CH1;   // as wired for the fan PWM mode built (fan.h)
+  if (plant.zones > 1) {
+    plant.zone[1].fanPin = FAN_CH2;
+  }
+  if (sensorZone < 0 || sensorZone >= plant.zones) {
+    sensorZone = 0;
+  }
+
+  // Zone settings as if entered on the keypad before this power-on
+  HalHost_PowerOn();
+  EEPROM_HostErase();
+  s.num_of_zones = plant.zones > 1 && strlen(levels) > 1 ? 2 : 1;
+  s.temp1 = levels[0] - '0';
+  s.temp2 = s.num_of_zones == 2 ? levels[1] - '0' : 1;
+  if (s.temp1 < 1 || s.temp1 > 3 || s.temp2 < 1 || s.temp2 > 3) {
+    fprintf(stderr, "levels are 1, 2 or 3\n");
+    return 2;
+  }
+  Settings_Save(&s);
+  plant.zone[0].setPoint = Settings_LevelToTemp(s.temp1);
+  if (s.num_of_zones == 2) {
+    plant.zone[1].setPoint = Settings_LevelToTemp(s.temp2);
+  } else if (plant.zones > 1) {
+    plant.zone[1].fanPin = -1;   // firmware leaves the zone 2 fan off
+  }
+
+  halHost.sciTx = countSci;
+  halHost.pth = Plant_SensorDip(ambient) | PORTH_POWER_BIT;
+  halHost.atd[5] = Plant_SensorAtd(ambient);
+  HalHost_SetVector(HAL_VEC_IRQ, Control_Stop);
+  HalHost_SetVector(HAL_VEC_TIMCH0, Control_Fan1);
+  HalHost_SetVector(HAL_VEC_TIMCH6, Control_InputTick);
+  HalHost_SetVector(HAL_VEC_TIMCH7, Control_Fan2);
+  HalHost_SetVector(HAL_VEC_MDCU, Control_Tick);
+  HalHost_SetVector(HAL_VEC_RTI, RTC_Tick);
+  HalHost_SetVector(HAL_VEC_SCI1, SCI1_RxService);
+  endCycles = (unsigned long long)(hours * 3600.0 * HAL_HOST_BUS_HZ);
+  HalHost_SetEnvironment(environment, STEP_CYCLES);
+  if (csv) {
+    fprintf(csv, "time_s,door");
+    for (i = 0; i < plant.zones; i++) {
+      fprintf(csv, ",t%d_F,duty%d", i + 1, i + 1);
+    }
+    fprintf(csv, "\n");
+  }
+
+  start = clock();
+  if (setjmp(done) == 0) {
+    if (setjmp(halHostRestart)) {   // HAL_RESTART() comes back here
+      restarts++;
+    }
+    Control_Main();
+  }
+  wall = (double)(clock() - start) / CLOCKS_PER_SEC;
+  if (csv) {
+    fclose(csv);
+  }
+
+  printf("%.2f h simulated, room %.1f F, door open %.1f %% of the time, %d restarts\n",
+         plant.time / 3600.0, plant.ambient, 100.0 * plant.doorTime / plant.time, restarts);
+  printf("zone  set F  end F  min F  max F  |err| F  rms F  duty %%\n");
+  for (i = 0; i < plant.zones; i++) {
+    PlantZone *z = &plant.zone[i];
+    if (z->fanPin < 0) {   // not controlled, no set point
+      printf("%4d      - %6.1f %6.1f %6.1f        -      - %7.1f\n", i + 1,
+             z->temp, z->tMin, z->tMax, 0.0);
+      continue;
+    }
+    printf("%4d %6.1f %6.1f %6.1f %6.1f %8.2f %6.2f %7.1f\n", i + 1,
+           z->setPoint, z->temp, z->tMin, z->tMax,
+           z->errAbs / plant.time, sqrt(z->errSq / plant.time),
+           100.0 * z->dutySum / plant.time);
+  }
+  printf("fan PWM period us: PT%u %lu..%lu  PT%u %lu..%lu, forced edges %lu %lu\n",
+         FAN_CH1, halHost.ptPeriodMin[FAN_CH1] / (HAL_HOST_BUS_HZ / 1000000),
+         halHost.ptPeriodMax[FAN_CH1] / (HAL_HOST_BUS_HZ / 1000000),
+         FAN_CH2, halHost.ptPeriodMin[FAN_CH2] / (HAL_HOST_BUS_HZ / 1000000),
+         halHost.ptPeriodMax[FAN_CH2] / (HAL_HOST_BUS_HZ / 1000000),
+         halHost.ptForced[FAN_CH1], halHost.ptForced[FAN_CH2]);
+  printf("energy %.1f Wh, %.2f h simulated per wall second\n",
+         Plant_Energy(&plant), wall > 0 ? plant.time / 3600.0 / wall : 0.0);
+  return 0;
+}
@@ -0,0 +1,416 @@
+// filename  ***************  hal_host.c  *************************
+// Hardware abstraction, host implementation: register model and time
+// See hal_host.h
+
+#include <stdio.h>
+#include <string.h>
+#include "hal.h"
+
+HalHostModel halHost;
+jmp_buf halHostRestart;
+
+//-------------------------HalHost_PowerOn--------------------
+// Clears the whole model, as after power-on (PORF set, I bit set)
+// Input: none
+// Output: none
+void HalHost_PowerOn(void) {
+  memset(&halHost, 0, sizeof(halHost));
+  halHost.ibit = 1;
+  halHost.porf = 1;
+  halHost.key = HAL_HOST_NO_KEY;
+  halHost.sciTxCycles = HAL_HOST_SCI_BYTE_CYCLES;
+  memset(halHost.lcd, ' ', sizeof(halHost.lcd));
+  halHost.lcd[0][HAL_HOST_LCD_COLS] = halHost.lcd[1][HAL_HOST_LCD_COLS] = 0;
+}
+
+//-------------------------HalHost_SetVector------------------
+// Registers an interrupt handler
+// Input: HAL_VEC_ source, handler (NULL leaves the source unserviced)
+// Output: none
+void HalHost_SetVector(int vec, void (*handler)(void)) {
+  halHost.vector[vec] = handler;
+}
+
+//-------------------------HalHost_SetEnvironment-------------
+// Registers a function that updates the inputs as time passes
+// Input: function, period in bus cycles
+// Output: none
+void HalHost_SetEnvironment(void (*env)(void), unsigned long period) {
+  halHost.env = env;
+  halHost.envPeriod = period;
+  halHost.envNext = halHost.cycles + period;
+}
+
+// Highest priority source with its flag and enable set, -1 if none
+static int pending(void) {
+  unsigned char ch, flags;
+
+  if (halHost.irqEnabled && halHost.irqPending) {
+    return HAL_VEC_IRQ;
+  }
+  if (halHost.rtie && halHost.rtif) {
+    return HAL_VEC_RTI;
+  }
+  flags = halHost.tflg1 & halHost.tie;
+  for (ch = 0; ch < 8; ch++) {
+    if (flags & (1 << ch)) {
+      return HAL_VEC_TIMCH0 + ch;
+    }
+  }
+  if ((halHost.tflg2 & 0x80) && (halHost.tscr2 & 0x80)) {
+    return HAL_VEC_TIMOVF;
+  }
+  if (halHost.sciRie && halHost.sciRxHead != halHost.sciRxTail) {
+    return HAL_VEC_SCI1;
+  }
+  if ((halHost.mcflg & 0x80) && (halHost.mcctl & 0x80)) {
+    return HAL_VEC_MDCU;
+  }
+  return -1;
+}
+
+// Runs handlers until nothing is pending, the CPU sets I on entry
+static void dispatch(void) {
+  int vec;
+  unsigned long spins = 0;
+
+  if (halHost.ibit || halHost.inIsr) {
+    return;
+  }
+  while ((vec = pending()) >= 0) {
+    if (vec == HAL_VEC_IRQ) {
+      halHost.irqPending = 0;   // edge latch clears on the vector fetch
+    }
+    if (halHost.vector[vec] == NULL || ++spins > 100000UL) {
+      fprintf(stderr, "hal_host: interrupt source %d not serviced, masked\n", vec);
+      if (vec == HAL_VEC_TIMOVF) {
+        halHost.tscr2 &= ~0x80;
+      } else if (vec == HAL_VEC_SCI1) {
+        halHost.sciRie = 0;
+      } else if (vec == HAL_VEC_MDCU) {
+        halHost.mcctl &= ~0x80;
+      } else if (vec == HAL_VEC_RTI) {
+        halHost.rtie = 0;
+      } else if (vec != HAL_VEC_IRQ) {
+        halHost.tie &= ~(1 << (vec - HAL_VEC_TIMCH0));
+      }
+      continue;
+    }
+    halHost.isrCount[vec]++;
+    halHost.inIsr = 1;
+    halHost.ibit = 1;
+    halHost.vector[vec]();
+    halHost.inIsr = 0;
+    halHost.ibit = 0;
+  }
+}
+
+// New port T levels; times the period of every output compare pin
+// that rises. A compare can't schedule further out than one TCNT wrap,
+// longer gaps are a pin held low or high and don't count as a period.
+static void setPins(byte ptt) {
+  unsigned long period;
+  unsigned char ch, rise;
+
+  rise = ptt & ~halHost.ptt & halHost.tios;
+  halHost.ptt = ptt;
+  for (ch = 0; rise; rise >>= 1, ch++) {
+    if ((rise & 1) == 0) {
+      continue;
+    }
+    period = (unsigned long)(halHost.cycles - halHost.ptRise[ch]);
+    if (halHost.ptRise[ch] && period <= 0x10000UL << (halHost.tscr2 & 7)) {
+      if (halHost.ptPeriodMin[ch] == 0 || period < halHost.ptPeriodMin[ch]) {
+        halHost.ptPeriodMin[ch] = period;
+      }
+      if (period > halHost.ptPeriodMax[ch]) {
+        halHost.ptPeriodMax[ch] = period;
+      }
+    }
+    halHost.ptRise[ch] = halHost.cycles;
+  }
+}
+
+// Pin action of one output compare channel
+static void pinAction(unsigned char ch) {
+  unsigned char action;
+
+  action = ((ch < 4 ? halHost.tctl2 : halHost.tctl1) >> ((ch & 3) << 1)) & 3;
+  switch (action) {
+    case HAL_OC_TOGGLE: setPins(halHost.ptt ^ (1 << ch)); break;
+    case HAL_OC_CLEAR:  setPins(halHost.ptt & ~(1 << ch)); break;
+    case HAL_OC_SET:    setPins(halHost.ptt | (1 << ch)); break;
+  }
+}
+
+// Output compare match on one channel: flag and pin action; OC7 also
+// puts OC7D on the OC7M pins, after the other channels (it has priority)
+static void compare(unsigned char ch) {
+  halHost.tflg1 |= 1 << ch;
+  pinAction(ch);
+  if (ch == 7) {
+    setPins((halHost.ptt & ~(halHost.oc7m & 0x7F)) | (halHost.oc7d & halHost.oc7m & 0x7F));
+  }
+}
+
+//-------------------------HalHost_Advance--------------------
+// Lets time pass in steps up to the next timer event or environment
+// update, servicing interrupts after each step
+// Input: bus cycles
+// Output: none
+void HalHost_Advance(unsigned long cycles) {
+  static const byte mcDiv[4] = { 1, 4, 8, 16 };   // MCCTL MCPR1:0
+  unsigned long prescaler, ticks, step, t, mcPrescaler = 1;
+  unsigned char ch, pins;
+
+  while (cycles > 0) {
+    // Cycles to the next timer event (compare match or overflow)
+    step = cycles;
+    if (halHost.tscr1 & 0x80) {
+      prescaler = 1UL << (halHost.tscr2 & 7);
+      ticks = 0x10000UL - halHost.tcnt;
+      for (ch = 0; ch < 8; ch++) {
+        if (halHost.tios & (1 << ch)) {
+          t = (word)(halHost.tc[ch] - halHost.tcnt);
+          if (t == 0) {
+            t = 0x10000UL;
+          }
+          if (t < ticks) {
+            ticks = t;
+          }
+        }
+      }
+      t = ticks * prescaler - halHost.prescale;
+      if (t < step) {
+        step = t;
+      }
+    }
+    if ((halHost.mcctl & 0x04) && halHost.mccnt) {
+      mcPrescaler = mcDiv[halHost.mcctl & 3];
+      t = halHost.mccnt * mcPrescaler - halHost.mcprescale;   // to the underflow
+      if (t < step) {
+        step = t;
+      }
+    }
+    if (halHost.rtiPeriod && halHost.rtiLeft < step) {
+      step = halHost.rtiLeft;
+    }
+    if (halHost.env && halHost.envNext - halHost.cycles < step) {
+      step = (unsigned long)(halHost.envNext - halHost.cycles);
+    }
+
+    for (pins = halHost.ptt & halHost.tios, ch = 0; pins; pins >>= 1, ch++) {
+      if (pins & 1) {
+        halHost.ptHigh[ch] += step;
+      }
+    }
+    halHost.cycles += step;
+    cycles -= step;
+    if (halHost.tscr1 & 0x80) {
+      t = halHost.prescale + step;
+      ticks = t / prescaler;
+      halHost.prescale = t % prescaler;
+      if (ticks > 0) {
+        if (halHost.tcnt + ticks > 0xFFFFUL) {
+          halHost.tflg2 |= 0x80;
+        }
+        halHost.tcnt = (word)(halHost.tcnt + ticks);
+        halHost.ticks += ticks;
+        for (ch = 0; ch < 8; ch++) {
+          if ((halHost.tios & (1 << ch)) && halHost.tc[ch] == halHost.tcnt) {
+            compare(ch);
+          }
+        }
+      }
+    }
+    if ((halHost.mcctl & 0x04) && halHost.mccnt) {
+      t = halHost.mcprescale + step;
+      halHost.mccnt -= (word)(t / mcPrescaler);
+      halHost.mcprescale = t % mcPrescaler;
+      if (halHost.mccnt == 0) {
+        halHost.mcflg |= 0x80;
+        halHost.mccnt = halHost.mcload;   // modulus mode reloads
+      }
+    }
+    if (halHost.rtiPeriod) {
+      halHost.rtiLeft -= step;
+      if (halHost.rtiLeft == 0) {
+        halHost.rtif = 1;
+        halHost.rtiLeft = halHost.rtiPeriod;
+      }
+    }
+    if (halHost.env && halHost.cycles >= halHost.envNext) {
+      halHost.envNext += halHost.envPeriod;
+      halHost.env();
+    }
+    dispatch();
+  }
+}
+
+//-------------------------HalHost_EnableInterrupts-----------
+// Clears the I bit and services whatever is pending
+// Input: none
+// Output: none
+void HalHost_EnableInterrupts(void) {
+  halHost.ibit = 0;
+  dispatch();
+}
+
+//-------------------------HalHost_Irq------------------------
+// Falling edge on the IRQ pin (stop switch)
+// Input: none
+// Output: none
+void HalHost_Irq(void) {
+  halHost.irqPending = 1;
+  dispatch();
+}
+
+//-------------------------HalHost_OcForce--------------------
+// Output compare pin action without a match (CFORC), no flag
+// Input: channel
+// Output: none
+void HalHost_OcForce(unsigned char ch) {
+  halHost.ptForced[ch]++;
+  pinAction(ch);
+}
+
+//-------------------------HalHost_Restart--------------------
+// Masks interrupts, leaves the running handler and jumps back to the
+// runner's setjmp(halHostRestart)
+// Input: none
+// Output: never returns
+void HalHost_Restart(void) {
+  halHost.ibit = 1;
+  halHost.inIsr = 0;
+  longjmp(halHostRestart, 1);
+}
+
+//-------------------------HalHost_KeypadScan-----------------
+// Port A as read back after driving one keypad row low
+// Input: row pattern written to port A (0xFE, 0xFD, 0xFB, 0xF7)
+// Output: row pattern with the pressed key's column pulled low
+byte HalHost_KeypadScan(byte row) {
+  byte key = halHost.key;
+
+  halHost.porta = row;
+  if (key != HAL_HOST_NO_KEY && (row & (1 << (key >> 2))) == 0) {
+    return row & ~(0x10 << (key & 3));
+  }
+  return row;
+}
+
+//-------------------------HalHost_SciRx----------------------
+// Next queued SCI input byte
+// Input: none
+// Output: byte, 0 if the queue is empty
+byte HalHost_SciRx(void) {
+  byte c;
+
+  if (halHost.sciRxHead == halHost.sciRxTail) {
+    return 0;
+  }
+  c = halHost.sciRx[halHost.sciRxTail];
+  halHost.sciRxTail = (halHost.sciRxTail + 1) % HAL_HOST_SCI_RX_SIZE;
+  return c;
+}
+
+//-------------------------HalHost_SciTx----------------------
+// Transmitted byte: to the registered sink, or stdout, then waits out
+// its frame like SCI1_OutChar polling TDRE
+// Input: byte
+// Output: none
+void HalHost_SciTx(byte c) {
+  halHost.sciTxCount++;
+  if (halHost.sciTx) {
+    halHost.sciTx(c);
+  } else {
+    putchar(c);
+  }
+  if (halHost.sciTxCycles) {
+    HalHost_Advance(halHost.sciTxCycles);
+  }
+}
+
+//-------------------------HalHost_SciInput-------------------
+// Queues bytes for the SCI receiver
+// Input: bytes, count
+// Output: number queued (the rest did not fit)
+int HalHost_SciInput(const char *s, int len) {
+  int n;
+  byte next;
+
+  for (n = 0; n < len; n++) {
+    next = (halHost.sciRxHead + 1) % HAL_HOST_SCI_RX_SIZE;
+    if (next == halHost.sciRxTail) {
+      break;
+    }
+    halHost.sciRx[halHost.sciRxHead] = s[n];
+    halHost.sciRxHead = next;
+  }
+  return n;
+}
+
+// One byte for the LCD controller: clear, set address, or a character
+static void lcdByte(byte rs, byte b) {
+  if (rs) {
+    if ((halHost.lcdAddr & 0x3F) < HAL_HOST_LCD_COLS) {
+      halHost.lcd[halHost.lcdAddr >> 6][halHost.lcdAddr & 0x3F] = b;
+    }
+    halHost.lcdAddr = (halHost.lcdAddr & 0x40) | ((halHost.lcdAddr + 1) & 0x3F);
+  } else if (b & 0x80) {
+    halHost.lcdAddr = b & 0x7F;
+  } else if (b == 0x01) {
+    memset(halHost.lcd[0], ' ', HAL_HOST_LCD_COLS);
+    memset(halHost.lcd[1], ' ', HAL_HOST_LCD_COLS);
+    halHost.lcdAddr = 0;
+  }
+}
+
+//-------------------------HalHost_LcdWrite-------------------
+// Port K write: RS = PK0, E = PK1, D4..D7 = PK2..PK5
+// Nibbles are latched on the falling edge of E. The reset sequence
+// (0x3 nibbles, then 0x2) is taken one nibble per command, after
+// that nibbles pair up high first.
+// Input: port K value
+// Output: none
+void HalHost_LcdWrite(byte v) {
+  byte falling = (halHost.portk & 0x02) && !(v & 0x02);
+  byte rs = v & 0x01;
+  byte n = (v >> 2) & 0x0F;
+
+  halHost.portk = v;
+  if (!falling) {
+    return;
+  }
+  if (!rs && !halHost.lcdHalf && n == 0x3) {
+    halHost.lcdInit8 = 1;     // function set, 8-bit interface
+    return;
+  }
+  if (!rs && !halHost.lcdHalf && halHost.lcdInit8 && n == 0x2) {
+    halHost.lcdInit8 = 0;     // switched to 4-bit, pairs from now on
+    return;
+  }
+  if (!halHost.lcdHalf) {
+    halHost.lcdHigh = n;
+    halHost.lcdHalf = 1;
+    return;
+  }
+  halHost.lcdHalf = 0;
+  lcdByte(rs, (halHost.lcdHigh << 4) | n);
+}
+
+//-------------------------HalHost_LcdLine--------------------
+// Visible text of one LCD line, trailing spaces removed
+// Input: line 1 or 2
+// Output: NUL terminated string inside the model
+const char *HalHost_LcdLine(int line) {
+  static char text[2][17];
+  char *t = text[(line - 1) & 1];
+  int i;
+
+  memcpy(t, halHost.lcd[(line - 1) & 1], 16);
+  for (i = 16; i > 0 && t[i - 1] == ' '; i--) {
+  }
+  t[i] = 0;
+  return t;
+}
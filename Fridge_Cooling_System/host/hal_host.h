@@ -0,0 +1,267 @@
+// filename  ***************  hal_host.h  *************************
+// Hardware abstraction, host implementation (see Sources/hal.h)
+//
+// The registers the application uses live in an in-memory model, halHost.
+// Time only passes in HalHost_Advance(), which steps the timer, sets the
+// flags and calls the registered interrupt handlers in HCS12 priority
+// order, like the CPU would between instructions. HAL_IDLE and
+// HAL_DELAY_MS advance it, so every busy-wait loop lets time move on.
+// ATD and the LCD bus complete instantly. A transmitted SCI byte takes
+// its frame time (sciTxCycles) with the I bit as it is, so a handler
+// that sends holds off the other interrupts like on the target.
+
+#include <setjmp.h>
+
+typedef unsigned char byte;
+typedef unsigned short word;
+
+#define HAL_HOST_BUS_HZ      CLOCK_BUS_HZ              // bus clock of the modelled MCU (clock.h)
+#define HAL_HOST_IDLE_CYCLES (HAL_HOST_BUS_HZ / 10000)  // 100 us per busy-wait poll
+#define HAL_HOST_SCI_RX_SIZE 64
+#define HAL_HOST_SCI_BAUD    9600
+#define HAL_HOST_SCI_BYTE_CYCLES (HAL_HOST_BUS_HZ * 10 / HAL_HOST_SCI_BAUD)  // start, 8 data, stop
+// RTI period: (RTR3:0 + 1) * 2^(RTR6:4 + 9) OSCCLK periods, in bus cycles
+#define HAL_HOST_RTI_CYCLES(ctl) \
+  (((((ctl) & 0x0FUL) + 1) << ((((ctl) >> 4) & 7) + 9)) * (HAL_HOST_BUS_HZ / CLOCK_OSC_HZ))
+#define HAL_HOST_LCD_COLS    40           // DDRAM per line, 16 are visible
+
+// Interrupt sources, highest priority first (vector table order)
+enum {
+  HAL_VEC_IRQ,
+  HAL_VEC_RTI,
+  HAL_VEC_TIMCH0, HAL_VEC_TIMCH1, HAL_VEC_TIMCH2, HAL_VEC_TIMCH3,
+  HAL_VEC_TIMCH4, HAL_VEC_TIMCH5, HAL_VEC_TIMCH6, HAL_VEC_TIMCH7,
+  HAL_VEC_TIMOVF,
+  HAL_VEC_SCI1,
+  HAL_VEC_MDCU,
+  HAL_VEC_COUNT
+};
+
+typedef struct _halHostModel {
+  // CPU
+  unsigned long long cycles;   // bus cycles since power-on
+  byte ibit;                   // interrupts masked (I bit)
+  byte inIsr;                  // a handler is running, no nesting
+  byte porf;                   // power-on reset flag (CRGFLG PORF)
+  byte irqEnabled, irqPending; // IRQ pin, falling edge latched
+  void (*vector[HAL_VEC_COUNT])(void);
+  unsigned long isrCount[HAL_VEC_COUNT];
+  // GPIO
+  byte porta;                  // keypad row output
+  byte key;                    // key held down, row * 4 + column, or HAL_HOST_NO_KEY
+  byte pth;                    // DIP switches
+  byte portb;                  // LEDs
+  byte ptt;                    // buzzer, fan pins driven by output compare (fan.h)
+  unsigned long long ptHigh[8];  // bus cycles each output compare pin spent high
+  unsigned long long ptRise[8];  // cycle of the last rising edge, 0 before the first
+  unsigned long ptPeriodMin[8], ptPeriodMax[8];  // rise to rise up to a TCNT wrap, bus cycles
+  unsigned long ptForced[8];   // pin actions forced through CFORC
+  byte ptp;
+  // Timer
+  byte tscr1, tscr2, tios, tie, tflg1, tflg2, tctl1, tctl2;
+  byte oc7m, oc7d;             // pins OC7 drives as well, and their levels
+  word tcnt;
+  unsigned long long ticks;    // TCNT increments since power-on
+  word tc[8];
+  unsigned long prescale;      // bus cycles into the current TCNT tick
+  byte mcctl, mcflg;           // modulus down-counter
+  word mccnt, mcload;
+  unsigned long mcprescale;    // bus cycles into the current MCCNT count
+  // Real-time interrupt
+  byte rtie, rtif;
+  unsigned long rtiPeriod;     // bus cycles, 0 while the RTI is off
+  unsigned long rtiLeft;       // bus cycles to the next RTIF
+  // ATD
+  byte atd[8];                 // value every conversion of the channel returns
+  // SCI
+  byte sciRx[HAL_HOST_SCI_RX_SIZE];
+  byte sciRxHead, sciRxTail;
+  byte sciRie;                 // receive interrupt enabled (SCI1CR2 RIE)
+  void (*sciTx)(byte c);       // NULL writes to stdout
+  unsigned long sciTxCycles;   // bus cycles a transmitted byte takes, 0 sends instantly
+  unsigned long sciTxCount;
+  // LCD controller (HD44780, 4-bit bus on port K)
+  byte portk;
+  byte lcdHigh, lcdHalf, lcdInit8;
+  byte lcdAddr;
+  char lcd[2][HAL_HOST_LCD_COLS + 1];
+  // Environment, called every envPeriod cycles (it may move envNext)
+  void (*env)(void);
+  unsigned long envPeriod;
+  unsigned long long envNext;
+} HalHostModel;
+
+#define HAL_HOST_NO_KEY 0xFF
+
+extern HalHostModel halHost;
+extern jmp_buf halHostRestart;   // HAL_RESTART() lands at the setjmp of the runner
+
+// GPIO
+#define HAL_GPIO_INIT()       (halHost.ptp = 0x0F)
+#define HAL_LEDS_RD()         (halHost.portb)
+#define HAL_LEDS_WR(v)        (halHost.portb = (v))
+#define HAL_BUZZER_TOGGLE()   (halHost.ptt ^= 0x20)
+#define HAL_BUZZER_OFF()      (halHost.ptt &= ~0x20)
+#define HAL_SEG_OFF()         (halHost.ptp = 0x0F)
+#define HAL_DIP_INIT()        ((void)0)
+#define HAL_DIP_RAW()         (halHost.pth)
+#define HAL_KEYPAD_RAW(row)   HalHost_KeypadScan(row)
+#define HAL_IRQ_INIT()        (halHost.irqEnabled = 1, halHost.irqPending = 0)
+
+// Timer / output compare
+#define HAL_TIMER_INIT(ctl2)   (halHost.tscr1 = 0x80, halHost.tscr2 = (ctl2), halHost.tflg2 = 0)
+#define HAL_TCNT()            (halHost.tcnt)
+#define HAL_TOF_PENDING()     (halHost.tflg2 & 0x80)
+#define HAL_TOF_ACK()         (halHost.tflg2 = 0)
+#define HAL_MDC_INIT(pr, count) (halHost.mcctl = 0xC4 | (pr), halHost.mcload = halHost.mccnt = (count), \
+                               halHost.mcflg = 0, halHost.mcprescale = 0)
+#define HAL_MDC_ACK()         (halHost.mcflg = 0)
+#define HAL_OC_INIT(ch)       (halHost.tflg1 &= ~(1 << (ch)), halHost.tie |= 1 << (ch), halHost.tios |= 1 << (ch))
+#define HAL_OC_RD(ch)         (halHost.tc[ch])
+#define HAL_OC_WR(ch, t)      (halHost.tc[ch] = (t))
+#define HAL_OC_ACK(ch)        (halHost.tflg1 &= ~(1 << (ch)))
+#define HAL_OC_IRQ_ON(ch)     (halHost.tie |= 1 << (ch))
+#define HAL_OC_IRQ_OFF(ch)    (halHost.tie &= ~(1 << (ch)))
+#define HAL_OC_FORCE(ch)      HalHost_OcForce(ch)
+#define HAL_OC7_INIT(mask)    (halHost.oc7d = 0, halHost.oc7m = (mask))
+#define HAL_OC7_DATA(d)       (halHost.oc7d = (d))
+#define HAL_OC_CTL(ch)        (*((ch) < 4 ? &halHost.tctl2 : &halHost.tctl1))
+#define HAL_OC_SHIFT(ch)      (((ch) & 3) << 1)
+#define HAL_OC_ACTION(ch, a)  (HAL_OC_CTL(ch) = (HAL_OC_CTL(ch) & ~(3 << HAL_OC_SHIFT(ch))) | ((a) << HAL_OC_SHIFT(ch)))
+#define HAL_OC_ACTION_RD(ch)  ((HAL_OC_CTL(ch) >> HAL_OC_SHIFT(ch)) & 3)
+
+// Real-time interrupt, every HAL_HOST_RTI_CYCLES(ctl) bus cycles. The
+// vector runs RTC_Tick only: prof.c is built but gets no samples, the
+// PROF_SAMPLES entry is target assembly
+#define HAL_RTI_INIT(ctl)     (halHost.rtiLeft = halHost.rtiPeriod = HAL_HOST_RTI_CYCLES(ctl), \
+                               halHost.rtif = 0, halHost.rtie = 1)
+#define HAL_RTI_ACK()         (halHost.rtif = 0)
+#define HAL_PPAGE()           0
+
+// ATD
+#define HAL_ATD_INIT()        ((void)0)
+#define HAL_ATD_RAW(ch)       (halHost.atd[(ch) & 7])
+
+// SCI1
+#define HAL_SCI_INIT(bdh, bdl) ((void)(bdh), (void)(bdl), halHost.sciRie = 1)
+#define HAL_SCI_RX_READY()    (halHost.sciRxHead != halHost.sciRxTail)
+#define HAL_SCI_RX_RAW()      HalHost_SciRx()
+#define HAL_SCI_TX_READY()    1
+#define HAL_SCI_TX(c)         HalHost_SciTx(c)
+#define HAL_SCI_BAUD(bdh, bdl) ((void)(bdh), (void)(bdl))
+#define HAL_SCI_TX_IDLE()     1
+
+// LCD bus
+#define HAL_LCD_INIT()        HalHost_LcdWrite(0x00)
+#define HAL_LCD_RD()          (halHost.portk)
+#define HAL_LCD_WR(v)         HalHost_LcdWrite(v)
+
+// System
+#define HAL_ENABLE_INTERRUPTS()   HalHost_EnableInterrupts()
+#define HAL_DISABLE_INTERRUPTS()  (halHost.ibit = 1)
+#define HAL_IDLE()                (Clock_Idle(), HalHost_Advance(HAL_HOST_IDLE_CYCLES))
+#define HAL_DELAY_MS(ms)          HalHost_Advance((unsigned long)(ms) * (HAL_HOST_BUS_HZ / 1000))
+#define HAL_RESTART()             HalHost_Restart()
+#define HAL_POWER_ON_RESET()      (halHost.porf)
+#define HAL_POWER_ON_ACK()        (halHost.porf = 0)
+#define HAL_TICKS()               ((unsigned long)halHost.ticks)
+#define HAL_CLOCK_INIT()          ((void)0)   // the model always runs at HAL_HOST_BUS_HZ
+#define HAL_CLOCK_SELECT(mode)    ((void)(mode), 0)   // mode is tracked by clock.c only
+#define HAL_CRITICAL_ENTER(ccr)   { (ccr) = halHost.ibit; halHost.ibit = 1; }
+#define HAL_CRITICAL_EXIT(ccr)    { if (((halHost.ibit = (ccr))) == 0) HalHost_EnableInterrupts(); }
+
+//-------------------------HalHost_PowerOn--------------------
+// Clears the whole model, as after power-on (PORF set, I bit set)
+// Input: none
+// Output: none
+extern void HalHost_PowerOn(void);
+
+//-------------------------HalHost_SetVector------------------
+// Registers an interrupt handler
+// Input: HAL_VEC_ source, handler (NULL leaves the source unserviced)
+// Output: none
+extern void HalHost_SetVector(int vec, void (*handler)(void));
+
+//-------------------------HalHost_SetEnvironment-------------
+// Registers a function that updates the inputs (DIP, ATD, keys) as
+// simulated time passes
+// Input: function, period in bus cycles
+// Output: none
+extern void HalHost_SetEnvironment(void (*env)(void), unsigned long period);
+
+//-------------------------HalHost_Advance--------------------
+// Lets time pass: steps TCNT, MCCNT and the RTI, fires output compares,
+// the overflow, the modulus counter underflow and the RTI,
+// applies pin actions and runs pending handlers (unless masked or
+// already inside one)
+// Input: bus cycles
+// Output: none
+extern void HalHost_Advance(unsigned long cycles);
+
+//-------------------------HalHost_EnableInterrupts-----------
+// Clears the I bit and services whatever is pending
+// Input: none
+// Output: none
+extern void HalHost_EnableInterrupts(void);
+
+//-------------------------HalHost_Irq------------------------
+// Falling edge on the IRQ pin (stop switch)
+// Input: none
+// Output: none
+extern void HalHost_Irq(void);
+
+//-------------------------HalHost_OcForce--------------------
+// Output compare pin action without a match (CFORC), no flag
+// Input: channel
+// Output: none
+extern void HalHost_OcForce(unsigned char ch);
+
+//-------------------------HalHost_Restart--------------------
+// HAL_RESTART(): masks interrupts, leaves the running handler and jumps
+// back to the runner's setjmp(halHostRestart)
+// Input: none
+// Output: never returns
+extern void HalHost_Restart(void);
+
+//-------------------------HalHost_KeypadScan-----------------
+// Port A as read back after driving one keypad row low
+// Input: row pattern written to port A (0xFE, 0xFD, 0xFB, 0xF7)
+// Output: row pattern with the pressed key's column pulled low
+extern byte HalHost_KeypadScan(byte row);
+
+//-------------------------HalHost_SciRx/HalHost_SciTx--------
+// SCI data register: next queued input byte / transmitted byte, which
+// lets sciTxCycles pass
+extern byte HalHost_SciRx(void);
+extern void HalHost_SciTx(byte c);
+
+//-------------------------HalHost_SciInput-------------------
+// Queues bytes for the SCI receiver
+// Input: bytes, count
+// Output: number queued (the rest did not fit)
+extern int HalHost_SciInput(const char *s, int len);
+
+//-------------------------HalHost_LcdWrite-------------------
+// Port K write: RS = PK0, E = PK1, D4..D7 = PK2..PK5
+// The controller model latches a nibble on the falling edge of E.
+// Input: port K value
+// Output: none
+extern void HalHost_LcdWrite(byte v);
+
+//-------------------------HalHost_LcdLine--------------------
+// Visible text of one LCD line, trailing spaces removed
+// Input: line 1 or 2
+// Output: NUL terminated string inside the model
+extern const char *HalHost_LcdLine(int line);
+
+//-------------------------HalHost_OcPin----------------------
+// Output compare pin level (PT0..PT7)
+// Input: channel
+// Output: 0 or 1
+#define HalHost_OcPin(ch)     ((halHost.ptt >> (ch)) & 1)
+
+//-------------------------EEPROM_HostErase-------------------
+// Host EEPROM (eeprom_host.c) back to all 0xFF, it survives power-on
+// Input: none
+// Output: none
+extern void EEPROM_HostErase(void);
@@ -0,0 +1,93 @@
+// filename  ***************  outlog.c  ***************************
+// Output log of a host run (see outlog.h)
+
+#include <string.h>
+#include "hal.h"
+#include "outlog.h"
+#include "fan.h"
+
+#define LINE_MAX_LEN  256
+
+static FILE *out;
+static char sciLine[LINE_MAX_LEN];
+static int sciLen;
+static unsigned long long lastHigh[8];
+static char lastSample[LINE_MAX_LEN];
+
+static unsigned long nowMs(void) {
+  return (unsigned long)(halHost.cycles / (HAL_HOST_BUS_HZ / 1000));
+}
+
+// SCI sink: one log line per LF, CR dropped, other control bytes in hex
+static void sciTx(byte c) {
+  if (c == '\n') {
+    sciLine[sciLen] = 0;
+    fprintf(out, "%lu sci %s\n", nowMs(), sciLine);
+    sciLen = 0;
+  } else if (c != '\r' && sciLen < LINE_MAX_LEN - 5) {
+    if (c >= 0x20 && c < 0x7F) {
+      sciLine[sciLen++] = c;
+    } else {
+      sciLen += sprintf(&sciLine[sciLen], "\\x%02X", c);
+    }
+  }
+}
+
+//-------------------------OutLog_Open------------------------
+// Starts logging to a file, takes over the SCI output
+// Input: open file
+// Output: none
+void OutLog_Open(FILE *f) {
+  out = f;
+  sciLen = 0;
+  lastSample[0] = 0;
+  memcpy(lastHigh, halHost.ptHigh, sizeof(lastHigh));
+  halHost.sciTx = sciTx;
+}
+
+//-------------------------OutLog_Sample----------------------
+// Logs fan duty and LCD if changed, call every OUTLOG_PERIOD
+// Input: none
+// Output: none
+void OutLog_Sample(void) {
+  char sample[LINE_MAX_LEN];
+  double d1, d2;
+
+  d1 = 100.0 * (halHost.ptHigh[FAN_CH1] - lastHigh[FAN_CH1]) / OUTLOG_PERIOD;
+  d2 = 100.0 * (halHost.ptHigh[FAN_CH2] - lastHigh[FAN_CH2]) / OUTLOG_PERIOD;
+  memcpy(lastHigh, halHost.ptHigh, sizeof(lastHigh));
+  snprintf(sample, sizeof(sample), "fan %.1f %.1f |%s|", d1, d2, HalHost_LcdLine(1));
+  snprintf(sample + strlen(sample), sizeof(sample) - strlen(sample), "%s|", HalHost_LcdLine(2));
+  if (strcmp(sample, lastSample) != 0) {
+    strcpy(lastSample, sample);
+    fprintf(out, "%lu %s\n", nowMs(), sample);
+  }
+}
+
+//-------------------------OutLog_Diff------------------------
+// Compares two logs line by line, prints the first differences
+// Input: log, reference log
+// Output: number of differing lines
+long OutLog_Diff(FILE *log, FILE *ref) {
+  char a[LINE_MAX_LEN + 16], b[LINE_MAX_LEN + 16];
+  char *pa, *pb;
+  long line = 0, diffs = 0;
+
+  rewind(log);
+  rewind(ref);
+  for (;;) {
+    pa = fgets(a, sizeof(a), log);
+    pb = fgets(b, sizeof(b), ref);
+    if (!pa && !pb) {
+      break;
+    }
+    line++;
+    if (!pa || !pb || strcmp(a, b) != 0) {
+      if (++diffs <= 10) {
+        printf("line %ld\n  replay: %s  ref:    %s", line,
+               pa ? a : "(end)\n", pb ? b : "(end)\n");
+      }
+    }
+  }
+  return diffs;
+}
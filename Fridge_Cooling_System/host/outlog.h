@@ -0,0 +1,29 @@
+// filename  ***************  outlog.h  ***************************
+// Output log of a host run: fan duty, LCD contents and SCI text lines,
+// one line per change with the simulated time in ms. fridge_host -O and
+// fridge_replay write the same format, so runs can be diffed.
+//
+//   <ms> fan <duty1 %> <duty2 %> |<LCD line 1>|<LCD line 2>|
+//   <ms> sci <text>
+
+#include <stdio.h>
+
+#define OUTLOG_PERIOD   (HAL_HOST_BUS_HZ / 10)   // fan/LCD sample every 100 ms
+
+//-------------------------OutLog_Open------------------------
+// Starts logging to a file, takes over the SCI output
+// Input: open file
+// Output: none
+extern void OutLog_Open(FILE *f);
+
+//-------------------------OutLog_Sample----------------------
+// Logs fan duty and LCD if changed, call every OUTLOG_PERIOD
+// Input: none
+// Output: none
+extern void OutLog_Sample(void);
+
+//-------------------------OutLog_Diff------------------------
+// Compares two logs line by line, prints the first differences
+// Input: log, reference log
+// Output: number of differing lines
+extern long OutLog_Diff(FILE *log, FILE *ref);
@@ -0,0 +1,104 @@
+// filename  ***************  plant.c  ****************************
+// Thermal model of the refrigerator cabinet (see plant.h)
+
+#include <string.h>
+#include "plant.h"
+
+//-------------------------Plant_Init-------------------------
+// Default cabinet: two zones at room temperature, 75 F room
+// Input: model, number of zones 1..PLANT_ZONES
+// Output: none
+void Plant_Init(Plant *p, int zones) {
+  int i;
+
+  memset(p, 0, sizeof(*p));
+  p->zones = zones < 1 ? 1 : zones > PLANT_ZONES ? PLANT_ZONES : zones;
+  p->ambient = 75.0;
+  p->uaDivider = 0.5;
+  p->cop = 2.0;
+  p->fanWatts = 4.0;
+  for (i = 0; i < p->zones; i++) {
+    p->zone[i].temp = p->ambient;
+    p->zone[i].capacity = 30000.0;   // about 30 kg of food and air
+    p->zone[i].uaWall = 1.0;
+    p->zone[i].uaDoor = 15.0;
+    p->zone[i].coolPower = 80.0;
+    p->zone[i].fanPin = i == 0 ? 0 : i == 1 ? 7 : -1;   // PT0 zone 1, PT7 zone 2 (FAN_CH1/2)
+    p->zone[i].setPoint = 30.0;
+    p->zone[i].tMin = p->zone[i].tMax = p->ambient;
+  }
+}
+
+//-------------------------Plant_Step-------------------------
+// Advances the model, explicit Euler
+// Input: model, time step in s, fan duty 0..1 per zone
+// Output: none
+void Plant_Step(Plant *p, double dt, const double *duty) {
+  double flow[PLANT_ZONES], err;
+  int i;
+
+  for (i = 0; i < p->zones; i++) {
+    PlantZone *z = &p->zone[i];
+    flow[i] = (z->uaWall + (p->door ? z->uaDoor : 0.0)) * (p->ambient - z->temp)
+            - duty[i] * z->coolPower;
+    if (i > 0) {
+      flow[i] += p->uaDivider * (p->zone[i - 1].temp - z->temp);
+    }
+    if (i + 1 < p->zones) {
+      flow[i] += p->uaDivider * (p->zone[i + 1].temp - z->temp);
+    }
+  }
+  for (i = 0; i < p->zones; i++) {
+    PlantZone *z = &p->zone[i];
+    z->temp += flow[i] * dt / z->capacity;
+    err = z->temp - z->setPoint;
+    z->errAbs += (err < 0 ? -err : err) * dt;
+    z->errSq += err * err * dt;
+    if (z->temp < z->tMin) z->tMin = z->temp;
+    if (z->temp > z->tMax) z->tMax = z->temp;
+    z->dutySum += duty[i] * dt;
+    z->heatRemoved += duty[i] * z->coolPower * dt;
+  }
+  p->time += dt;
+  if (p->door) {
+    p->doorTime += dt;
+  }
+}
+
+//-------------------------Plant_Energy-----------------------
+// Electrical energy used since Plant_Init, compressor and fans
+// Input: model
+// Output: Wh
+double Plant_Energy(const Plant *p) {
+  double j = 0.0;
+  int i;
+
+  for (i = 0; i < p->zones; i++) {
+    j += p->zone[i].heatRemoved / p->cop + p->zone[i].dutySum * p->fanWatts;
+  }
+  return j / 3600.0;
+}
+
+//-------------------------Plant_SensorDip--------------------
+// Port H temperature bits the firmware reads for a temperature
+// Input: F
+// Output: 0..31
+unsigned char Plant_SensorDip(double temp) {
+  double bits = temp - 14.0 + 0.5;
+
+  if (bits < 0.0) return 0;
+  if (bits > 31.0) return 31;
+  return (unsigned char)bits;
+}
+
+//-------------------------Plant_SensorAtd--------------------
+// ATD0 channel 5 reading of the room sensor
+// Input: F
+// Output: 8-bit conversion result
+unsigned char Plant_SensorAtd(double temp) {
+  double counts = (temp - 32.0) / 1.8 * 51.0 / 100.0 + 0.5;
+
+  if (counts < 0.0) return 0;
+  if (counts > 255.0) return 255;
+  return (unsigned char)counts;
+}
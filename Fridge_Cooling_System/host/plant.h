@@ -0,0 +1,73 @@
+// filename  ***************  plant.h  ****************************
+// Thermal model of the refrigerator cabinet for the host simulator
+//
+// Every zone is one lumped heat capacity. Heat flows in through the walls
+// and, while the door is open, through the door opening; neighbouring
+// zones exchange heat through the divider; the zone's evaporator fan
+// removes heat in proportion to its duty. Temperatures are in F, powers
+// in W, so conductances are W/F and capacities J/F.
+//
+//   C dT/dt = UAwall (Tamb - T) + door UAdoor (Tamb - T)
+//           + UAdiv (Tneighbour - T) - duty Pcool
+
+#define PLANT_ZONES      4
+
+typedef struct _plantZone {
+  double temp;         // F
+  double capacity;     // J/F, air and contents
+  double uaWall;       // W/F to the room
+  double uaDoor;       // W/F to the room while the door is open
+  double coolPower;    // W heat removed at 100 % fan duty
+  int    fanPin;       // output compare pin driving the fan, -1 for none
+  double setPoint;     // F, only for the error statistics
+  // Statistics since Plant_Init
+  double errAbs;       // integral of |T - setPoint| dt
+  double errSq;        // integral of (T - setPoint)^2 dt
+  double tMin, tMax;
+  double dutySum;      // integral of duty dt
+  double heatRemoved;  // J
+} PlantZone;
+
+typedef struct _plant {
+  int zones;
+  double ambient;      // F, room around the cabinet
+  double uaDivider;    // W/F between neighbouring zones
+  double cop;          // coefficient of performance, heat removed per electrical W
+  double fanWatts;     // electrical W per fan at 100 % duty
+  int door;            // door open
+  double time;         // s since Plant_Init
+  double doorTime;     // s with the door open
+  PlantZone zone[PLANT_ZONES];
+} Plant;
+
+//-------------------------Plant_Init-------------------------
+// Default cabinet: two zones at room temperature, 75 F room
+// Input: model, number of zones 1..PLANT_ZONES
+// Output: none
+extern void Plant_Init(Plant *p, int zones);
+
+//-------------------------Plant_Step-------------------------
+// Advances the model, explicit Euler
+// Input: model, time step in s, fan duty 0..1 per zone
+// Output: none
+extern void Plant_Step(Plant *p, double dt, const double *duty);
+
+//-------------------------Plant_Energy-----------------------
+// Electrical energy used since Plant_Init, compressor and fans
+// Input: model
+// Output: Wh
+extern double Plant_Energy(const Plant *p);
+
+//-------------------------Plant_SensorDip--------------------
+// Port H temperature bits the firmware reads for a temperature
+// (cur_temp = PTH0..4 + 14), clamped to what the switches can show
+// Input: F
+// Output: 0..PORTH_TEMP_MASK
+extern unsigned char Plant_SensorDip(double temp);
+
+//-------------------------Plant_SensorAtd--------------------
+// ATD0 channel 5 reading of the room sensor (about 1.96 C per count,
+// the firmware stops above 27 C)
+// Input: F
+// Output: 8-bit conversion result
+extern unsigned char Plant_SensorAtd(double temp);
@@ -0,0 +1,222 @@
+// filename  ***************  spsc_stress.c  **********************
+// Stress test of the lock-free SPSC queue (Sources/spsc.c) under a
+// randomized interrupt model
+//
+// A POSIX interval timer stands in for the producing interrupt: SIGALRM
+// arrives at random points of the consumer loop, inside Spsc_Get as
+// well, and its handler puts a random burst of elements, like an ISR
+// that preempts main() and runs to completion. The main loop is the
+// consumer and pauses now and then, so the ring also runs full. Every
+// element carries its sequence number in all of its bytes. Checked:
+//   - no loss, no duplication: the consumer gets every accepted
+//     element once, in order, and never a torn one
+//   - full: a put is refused exactly when size elements are waiting,
+//     and Spsc_Dropped counts the refusals (saturating at 255)
+//   - empty: a get that fails has taken everything put before it began
+// The rings cover 1, 2 and 5-byte elements at sizes 128, 8 and 2; the
+// 8-bit counters wrap many times.
+//
+// Usage: spsc_stress [-n elements] [-s seed]
+//   -n  elements passed through each ring, default 100000
+//   -s  random seed, default 1
+// Prints the interrupt count per ring, exits 1 at the first failure.
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+#include "spsc.h"
+
+#define WIDTH_MAX    8      // largest element below, bytes
+#define INTERVAL_US  40     // longest gap between two interrupts
+#define TIMEOUT_S    60     // a ring that doesn't drain in time failed
+
+typedef struct { unsigned char b[5]; } Rec5;
+
+SPSC_DEFINE(bytes, unsigned char, 128);
+SPSC_DEFINE(words, unsigned short, 8);
+SPSC_DEFINE(recs, Rec5, 2);
+
+static Spsc *const rings[] = { &bytes, &words, &recs };
+static const char *const ringNames[] = { "128 x 1 byte", "8 x 2 bytes", "2 x 5 bytes" };
+
+// Shared by the "ISR" and the consumer
+static Spsc *ring;
+static volatile unsigned long produced;   // elements accepted, ISR only
+static volatile unsigned long refused;    // puts refused while full, ISR only
+static volatile unsigned long target;     // elements to pass through the ring
+static volatile unsigned long interrupts, inGetHits;
+static volatile sig_atomic_t inGet;       // the consumer is inside Spsc_Get
+static volatile sig_atomic_t failed;      // first failure, the ISR can't print
+static volatile unsigned long failA, failB;
+
+static unsigned long isrSeed, mainSeed;   // one generator per side
+
+enum { FAIL_NONE, FAIL_PUT_FULL, FAIL_PUT_ROOM, FAIL_DROPPED };
+
+// xorshift, the "ISR" must not share state with main()
+static unsigned long next(unsigned long *s) {
+  *s ^= *s << 13;
+  *s ^= *s >> 17;
+  *s ^= *s << 5;
+  return *s & 0xFFFFFFFFUL;
+}
+
+// Element contents for a sequence number
+static void fill(unsigned char *item, unsigned char width, unsigned long seq) {
+  unsigned char i;
+
+  for (i = 0; i < width; i++) {
+    item[i] = (unsigned char)((seq >> (8 * (i & 3))) ^ (i * 0x5B));
+  }
+}
+
+// Next interrupt 1..INTERVAL_US from now
+static void arm(void) {
+  struct itimerval t;
+
+  memset(&t, 0, sizeof(t));
+  t.it_value.tv_usec = 1 + next(&isrSeed) % INTERVAL_US;
+  setitimer(ITIMER_REAL, &t, NULL);
+}
+
+// The producing interrupt: a burst of up to twice the ring size
+static void isr(int sig) {
+  unsigned char item[WIDTH_MAX];
+  unsigned char size = ring->mask + 1, waiting;
+  unsigned int burst;
+  unsigned long drops;
+
+  (void)sig;
+  interrupts++;
+  if (inGet) {
+    inGetHits++;
+  }
+  burst = next(&isrSeed) % (2U * size + 1);
+  while (burst-- && produced < target && !failed) {
+    fill(item, ring->width, produced);
+    waiting = Spsc_Count(ring);   // exact here, the consumer is stopped
+    if (Spsc_Put(ring, item)) {
+      if (waiting >= size) {
+        failed = FAIL_PUT_FULL, failA = produced, failB = waiting;
+      }
+      produced++;
+    } else {
+      refused++;
+      drops = refused < 0xFF ? refused : 0xFF;
+      if (waiting < size) {
+        failed = FAIL_PUT_ROOM, failA = produced, failB = waiting;
+      } else if (Spsc_Dropped(ring) != drops) {
+        failed = FAIL_DROPPED, failA = Spsc_Dropped(ring), failB = drops;
+      }
+    }
+  }
+  if (!failed) {
+    arm();
+  }
+}
+
+// Passes target elements through one ring, FALSE on a failure
+static int run(unsigned char r) {
+  unsigned char item[WIDTH_MAX], want[WIDTH_MAX];
+  unsigned long consumed = 0, before, spin;
+  struct itimerval off;
+  time_t start = time(NULL);
+  char got;
+
+  ring = rings[r];
+  Spsc_Reset(ring);
+  produced = refused = interrupts = inGetHits = 0;
+  arm();
+  while (consumed < target && !failed) {
+    before = produced;   // all of these were published before the get
+    inGet = 1;
+    got = Spsc_Get(ring, item);
+    inGet = 0;
+    if (got) {
+      fill(want, ring->width, consumed);
+      if (memcmp(item, want, ring->width) != 0) {
+        printf("%s: element %lu lost, duplicated or torn\n", ringNames[r], consumed);
+        failed = -1;
+        break;
+      }
+      consumed++;
+    } else if (consumed < before) {
+      printf("%s: get found the ring empty with %lu of %lu taken\n", ringNames[r], consumed, before);
+      failed = -1;
+      break;
+    }
+    if ((next(&mainSeed) & 15) == 0) {   // let the ring fill up now and then
+      for (spin = next(&mainSeed) % 2000; spin > 0; spin--) {
+        __asm__ volatile ("");
+      }
+    }
+    if (time(NULL) - start > TIMEOUT_S) {
+      printf("%s: timeout, %lu of %lu taken\n", ringNames[r], consumed, target);
+      failed = -1;
+      break;
+    }
+  }
+  memset(&off, 0, sizeof(off));
+  setitimer(ITIMER_REAL, &off, NULL);
+
+  switch (failed) {
+    case FAIL_NONE: break;
+    case FAIL_PUT_FULL:
+      printf("%s: put %lu accepted with %lu waiting\n", ringNames[r], failA, failB);
+      return 0;
+    case FAIL_PUT_ROOM:
+      printf("%s: put %lu refused with %lu waiting\n", ringNames[r], failA, failB);
+      return 0;
+    case FAIL_DROPPED:
+      printf("%s: dropped count %lu, %lu expected\n", ringNames[r], failA, failB);
+      return 0;
+    default: return 0;
+  }
+  if (Spsc_Count(ring) != 0 || Spsc_Get(ring, item)) {
+    printf("%s: elements left after the last one\n", ringNames[r]);
+    return 0;
+  }
+  printf("%-13s %lu elements, %lu refused while full, %lu interrupts, %lu inside Spsc_Get\n",
+         ringNames[r], consumed, refused, interrupts, inGetHits);
+  return 1;
+}
+
+int main(int argc, char **argv) {
+  struct sigaction sa;
+  unsigned char r;
+  int opt;
+
+  target = 100000;
+  isrSeed = 1;
+  while ((opt = getopt(argc, argv, "n:s:")) != -1) {
+    switch (opt) {
+      case 'n': target = strtoul(optarg, NULL, 0); break;
+      case 's': isrSeed = strtoul(optarg, NULL, 0); break;
+      default:
+        fprintf(stderr, "usage: %s [-n elements] [-s seed]\n", argv[0]);
+        return 2;
+    }
+  }
+  if (isrSeed == 0) {
+    isrSeed = 1;   // xorshift sticks at 0
+  }
+  mainSeed = isrSeed * 2654435761UL + 1;
+
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = isr;
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGALRM, &sa, NULL);
+
+  setvbuf(stdout, NULL, _IOLBF, 0);
+  for (r = 0; r < sizeof(rings) / sizeof(rings[0]); r++) {
+    if (!run(r)) {
+      return 1;
+    }
+  }
+  printf("spsc stress passed\n");
+  return 0;
+}
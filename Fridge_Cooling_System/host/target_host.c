@@ -0,0 +1,54 @@
+// filename  ***************  target_host.c  **********************
+// Host stand-ins for the drivers that only make sense on the MCU:
+// stack monitor (stackmon.h) and cycle benchmarks (bench.h)
+
+#include "hal.h"
+#include "sci1.h"
+#include "stackmon.h"
+#include "bench.h"
+
+void StackMon_Enter(unsigned char isr) {
+  (void)isr;
+}
+
+void StackMon_Exit(unsigned char isr) {
+  (void)isr;
+}
+
+unsigned short StackMon_Size(void) {
+  return 0;
+}
+
+unsigned short StackMon_HighWater(void) {
+  return 0;
+}
+
+unsigned short StackMon_Entry(unsigned char isr) {
+  (void)isr;
+  return 0;
+}
+
+unsigned short StackMon_Peak(unsigned char isr) {
+  (void)isr;
+  return 0;
+}
+
+char StackMon_Overflow(void) {
+  return 0;
+}
+
+void StackMon_Report(void) {
+  SCI1_OutString("Stack: not monitored on the host");
+  SCI1_OutChar(CR);
+  SCI1_OutChar(LF);
+}
+
+void Bench_FarCopy(void) {
+  SCI1_OutString("Bench: target only");
+  SCI1_OutChar(CR);
+  SCI1_OutChar(LF);
+}
+
+void Bench_FixedPoint(void) {
+  Bench_FarCopy();
+}
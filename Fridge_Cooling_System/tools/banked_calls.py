@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+"""Report banked code and paged data still reachable from the hot interrupts.
+
+Reads the linker map (bin/Project.map): the OBJECT-ALLOCATION SECTION gives
+every object's address, the DEPENDENCY TREE who references whom. Starting at
+the periodic interrupt handlers, every reachable object placed in paged
+flash (0x8000-0xBFFF window, printed as PPAGE:offset) is listed with one
+call path to it. Each one costs a CALL/RTC and a PPAGE switch, or a far
+access for data; move it into ISR_CODE (see prm/Project.prm) to get rid
+of it.
+
+Fault paths (IRQ stop button, overheating restart) are not hot and are
+cut off at the functions in COLD, they are listed separately with -a
+(up to the main() restart).
+
+Usage:
+    banked_calls.py                     # bin/Project.map next to tools/
+    banked_calls.py path/to/Project.map
+    banked_calls.py -a                  # include the fault paths
+    banked_calls.py --root TIMCH6_ISR   # only this handler
+
+Exits with 1 if anything banked is found on a hot path.
+"""
+import argparse
+import os
+import re
+import sys
+
+HOT_ROOTS = ["MDCU_ISR", "TIMCH0_ISR", "TIMCH6_ISR", "TIMCH7_ISR", "EEPROM_ISR", "RTI_ISR"]
+COLD_ROOTS = ["IRQ_ISR"]
+# Only entered when the controller stops: main() restarts after a fault,
+# EELog_Event records it.
+COLD = {"main", "EELog_Event"}
+
+ADDR_LINE = re.compile(r"^\s+(\w+)\s+([0-9A-F]{4,6})\s+[0-9A-F]+\s+\d+\s+\d+\s+(\S+)")
+TREE_LINE = re.compile(r"^([ |]*)\+- (\w+)")
+ROOT_LINE = re.compile(r"^ (\w+)\s*$")
+
+
+def is_banked(addr):
+    return addr > 0xFFFF or 0x8000 <= addr < 0xC000
+
+
+def section(lines, title):
+    """Lines between the heading containing title and the next star rule."""
+    out, inside = [], False
+    for line in lines:
+        if line.startswith("*****"):
+            if inside and out:
+                break
+            continue
+        if title in line:
+            inside = True
+            continue
+        if inside:
+            out.append(line)
+    return out
+
+
+def parse_map(text):
+    lines = text.splitlines()
+    addr, seg = {}, {}
+    for line in section(lines, "OBJECT-ALLOCATION SECTION"):
+        m = ADDR_LINE.match(line)
+        if m:
+            addr[m.group(1)] = int(m.group(2), 16)
+            seg[m.group(1)] = m.group(3)
+
+    calls = {}
+    stack = []
+    for line in section(lines, "DEPENDENCY TREE"):
+        m = ROOT_LINE.match(line)
+        if m and "Group" not in line:
+            stack = [m.group(1)]
+            calls.setdefault(m.group(1), set())
+            continue
+        m = TREE_LINE.match(line)
+        if not m or not stack:
+            continue
+        depth = len(m.group(1)) // 3 + 1
+        name = m.group(2)
+        del stack[depth:]
+        calls.setdefault(stack[-1], set()).add(name)
+        calls.setdefault(name, set())
+        stack.append(name)
+    return addr, seg, calls
+
+
+def walk(root, calls, stop):
+    """Breadth-first paths from root, not descending into stop."""
+    paths = {root: [root]}
+    todo = [root]
+    while todo:
+        name = todo.pop(0)
+        if name in stop and name != root:
+            continue
+        for callee in sorted(calls.get(name, ())):
+            if callee not in paths:
+                paths[callee] = paths[name] + [callee]
+                todo.append(callee)
+    return paths
+
+
+def report(roots, addr, seg, calls, stop, skip=frozenset()):
+    found = set()
+    for root in roots:
+        if root not in calls:
+            print("{}: not in the dependency tree".format(root))
+            continue
+        for name, path in sorted(walk(root, calls, stop).items()):
+            if name in addr and is_banked(addr[name]) and name not in skip | found:
+                found.add(name)
+                print("{:<20} {:06X} {:<12} {}".format(
+                    name, addr[name], seg[name], " -> ".join(path)))
+    return found
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("map", nargs="?", default=os.path.join(here, "..", "bin", "Project.map"))
+    ap.add_argument("-a", "--all", action="store_true", help="also list fault paths")
+    ap.add_argument("--root", action="append", help="interrupt handler to start from")
+    args = ap.parse_args()
+
+    with open(args.map) as f:
+        addr, seg, calls = parse_map(f.read())
+    if not addr or not calls:
+        sys.exit("{}: no allocation or dependency section, link the project first"
+                 .format(args.map))
+
+    print("banked objects on hot interrupt paths:")
+    roots = args.root or HOT_ROOTS
+    hot = report(roots, addr, seg, calls, COLD, COLD)
+    if not hot:
+        print("  none")
+    if args.all:
+        print("banked objects on fault paths:")
+        if not report(roots + COLD_ROOTS, addr, seg, calls, {"main"}, hot):
+            print("  none")
+    sys.exit(1 if hot else 0)
+
+
+if __name__ == "__main__":
+    main()
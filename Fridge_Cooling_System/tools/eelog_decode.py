@@ -0,0 +1,123 @@
+#!/usr/bin/env python3
+"""Decode the EEPROM temperature/fault history of the fridge controller.
+
+The firmware answers the SCI command 'L' with one binary frame
+(see Sources/eelog.h):
+
+    'E' 'L' count_hi count_lo  <count * 4 record bytes>  checksum
+
+Usage:
+    eelog_decode.py --port /dev/ttyUSB0     # send 'L' and decode the reply
+    eelog_decode.py dump.bin                # decode a captured frame
+
+Reading from a serial port needs pyserial.
+"""
+import argparse
+import sys
+
+LOG_KEY, LOG_DELTA, LOG_FAULT, LOG_BOOT = range(4)
+NO_SAMPLE = 0x8
+SAMPLE_PERIOD_S = 60   # log_period in control.c
+
+FAULTS = {
+    1: "overheating (ATD {arg})",
+    2: "door opened at {arg} F",
+    3: "stopped by IRQ button",
+    4: "EEPROM error #{arg}",
+    5: "stack overflow (high water {bytes} bytes)",
+}
+
+
+def find_frame(data):
+    """Return the record bytes of the first valid frame in data."""
+    start = 0
+    while True:
+        start = data.find(b"EL", start)
+        if start < 0 or len(data) < start + 4:
+            raise ValueError("no log frame found")
+        count = (data[start + 2] << 8) | data[start + 3]
+        end = start + 4 + 4 * count
+        if len(data) > end and sum(data[start + 4:end]) & 0xFF == data[end]:
+            return data[start + 4:end]
+        start += 1
+
+
+def nibble(n):
+    """Signed 4-bit delta, None for an empty slot."""
+    if n == NO_SAMPLE:
+        return None
+    return n - 16 if n & 0x8 else n
+
+
+def decode(records):
+    temp = atd = None
+    sample = 0
+    for i in range(0, len(records), 4):
+        seq, info, b2, b3 = records[i:i + 4]
+        kind = info >> 6
+        fans = "fan1=%d fan2=%d" % ((info >> 4) & 3, (info >> 2) & 3)
+        status = ("on" if info & 1 else "off") + (" door-open" if info & 2 else "")
+        if kind == LOG_KEY:
+            temp, atd = b2, b3
+            yield sample, seq, "sample  %3d F  atd=%3d  %s %s" % (temp, atd, fans, status)
+            sample += 1
+        elif kind == LOG_DELTA:
+            for dt, da in ((nibble(b2 >> 4), nibble(b3 >> 4)), (nibble(b2 & 0xF), nibble(b3 & 0xF))):
+                if dt is None:
+                    continue
+                if temp is None:      # oldest records precede the first key
+                    sample += 1
+                    continue
+                temp += dt
+                atd += da
+                yield sample, seq, "sample  %3d F  atd=%3d  %s %s" % (temp, atd, fans, status)
+                sample += 1
+        elif kind == LOG_FAULT:
+            text = FAULTS.get(b2, "fault {code} ({arg})").format(code=b2, arg=b3, bytes=4 * b3)
+            yield sample, seq, "FAULT   " + text
+        else:
+            yield sample, seq, "boot    zones=%d temp1=%d temp2=%d start=%d" % (
+                b2 >> 4, (b2 >> 2) & 3, b2 & 3, b3)
+            temp = atd = None         # a key record follows every start
+
+
+def read_port(port, baud):
+    import serial  # pyserial
+    with serial.Serial(port, baud, timeout=5) as ser:
+        ser.reset_input_buffer()
+        ser.write(b"L")
+        data = b""
+        while True:
+            chunk = ser.read(4096)
+            if not chunk:
+                return data
+            data += chunk
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("file", nargs="?", help="captured dump (default: stdin)")
+    ap.add_argument("--port", help="serial port to request the dump from")
+    ap.add_argument("--baud", type=int, default=9600)
+    ap.add_argument("--period", type=int, default=SAMPLE_PERIOD_S,
+                    help="seconds between samples (default %(default)s)")
+    args = ap.parse_args()
+
+    if args.port:
+        data = read_port(args.port, args.baud)
+    elif args.file:
+        with open(args.file, "rb") as f:
+            data = f.read()
+    else:
+        data = sys.stdin.buffer.read()
+
+    records = find_frame(data)
+    entries = list(decode(records))
+    last = entries[-1][0] if entries else 0
+    print("%d records" % (len(records) // 4))
+    for sample, seq, text in entries:
+        print("t-%6ds  #%3d  %s" % ((last - sample) * args.period, seq, text))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+"""Expand the numbered operator messages of the fridge controller.
+
+The firmware sends each message of Sources/msgs.def as a frame
+
+    0x1E id [arg_hi arg_lo]...      (one 16-bit argument per %u)
+
+(see Sources/msgs.h). This turns the frames back into text lines and
+passes all other output (command replies, reports) through unchanged.
+
+Usage:
+    msgs_expand.py --port /dev/ttyUSB0  # live console
+    msgs_expand.py capture.bin          # expand a capture
+
+Reading from a serial port needs pyserial.
+"""
+import argparse
+import os
+import re
+import sys
+
+MSG_FRAME = 0x1E
+HERE = os.path.dirname(os.path.abspath(__file__))
+MSG_LINE = re.compile(r'^MSG\(\s*(\w+)\s*,\s*(\d+)\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)', re.M)
+
+
+def load_messages(path):
+    with open(path) as f:
+        return [(int(m.group(2)), m.group(3)) for m in MSG_LINE.finditer(f.read())]
+
+
+def expand(chunks, messages, out):
+    """Copy bytes from chunks to out, replacing message frames by lines."""
+    frame = None
+    for chunk in chunks:
+        for b in chunk:
+            if frame is None:
+                if b == MSG_FRAME:
+                    frame = bytearray()
+                else:
+                    out.write(chr(b))
+                continue
+            frame.append(b)
+            msg_id = frame[0]
+            if msg_id >= len(messages):
+                out.write("<unknown message {}>\r\n".format(msg_id))
+                frame = None
+                continue
+            args, text = messages[msg_id]
+            if len(frame) < 1 + 2 * args:
+                continue
+            values = [(frame[1 + 2 * i] << 8) | frame[2 + 2 * i] for i in range(args)]
+            out.write(text.replace("%u", "{}").format(*values) + "\r\n")
+            frame = None
+        out.flush()
+
+
+def serial_chunks(port, baud):
+    import serial
+    with serial.Serial(port, baud, timeout=0.1) as ser:
+        while True:
+            data = ser.read(256)
+            if data:
+                yield data
+
+
+def file_chunks(f):
+    while True:
+        data = f.read(256)
+        if not data:
+            return
+        yield data
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("capture", nargs="?", help="captured SCI output (default: stdin)")
+    ap.add_argument("--port", help="serial port to read from")
+    ap.add_argument("--baud", type=int, default=9600)
+    ap.add_argument("--def", dest="msgs_def",
+                    default=os.path.join(HERE, "..", "Sources", "msgs.def"))
+    args = ap.parse_args()
+
+    messages = load_messages(args.msgs_def)
+    try:
+        if args.port:
+            expand(serial_chunks(args.port, args.baud), messages, sys.stdout)
+        elif args.capture:
+            with open(args.capture, "rb") as f:
+                expand(file_chunks(f), messages, sys.stdout)
+        else:
+            expand(file_chunks(sys.stdin.buffer), messages, sys.stdout)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,159 @@
+#!/usr/bin/env python3
+"""Generate Sources/msgs_packed.h, the dictionary compressed message table.
+
+Reads Sources/msgs.def and replaces substrings that occur in several
+messages by one byte codes 0x80..0xFE, each naming an entry of a small
+dictionary. Entries are picked greedily by bytes saved, counting the
+entry itself and its 2 byte offset. %u placeholders are never split.
+The firmware uses the output with MSG_TEXT and MSG_PACKED (msgs.h).
+
+Usage:
+    msgs_pack.py            # rewrite Sources/msgs_packed.h
+    msgs_pack.py --check    # exit 1 if msgs_packed.h is out of date
+"""
+import argparse
+import os
+import re
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+SOURCES = os.path.join(HERE, "..", "Sources")
+MSG_LINE = re.compile(r'^MSG\(\s*(\w+)\s*,\s*(\d+)\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)', re.M)
+FIRST_CODE = 0x80
+MAX_ENTRIES = 0xFF - FIRST_CODE
+
+
+def read_def(path):
+    """[(id, args, text)] in wire order, checks args against the %u count."""
+    with open(path) as f:
+        msgs = [(m.group(1), int(m.group(2)), m.group(3)) for m in MSG_LINE.finditer(f.read())]
+    for ident, args, text in msgs:
+        if text.count("%u") != args:
+            sys.exit("{}: {} has {} %u but declares {} arguments".format(
+                path, ident, text.count("%u"), args))
+        if any(ord(c) >= FIRST_CODE for c in text) or "\\" in text:
+            sys.exit("{}: {} must be plain ASCII without escapes".format(path, ident))
+    return msgs
+
+
+def runs(tokens):
+    """Maximal runs of plain characters, as (start, string)."""
+    out, start = [], None
+    for i, t in enumerate(tokens + [None]):
+        if isinstance(t, str) and t != "\0":
+            if start is None:
+                start = i
+        elif start is not None:
+            out.append((start, "".join(tokens[start:i])))
+            start = None
+    return out
+
+
+def best_entry(texts):
+    """Substring with the largest saving, or None if nothing pays."""
+    counts = {}
+    for tokens in texts:
+        for _, run in runs(tokens):
+            for i in range(len(run)):
+                for j in range(i + 3, len(run) + 1):
+                    sub = run[i:j]
+                    if "%u" in sub or sub.endswith("%") or sub.startswith("u") and i > 0 and run[i - 1] == "%":
+                        continue
+                    counts[sub] = counts.get(sub, 0) + 1
+    best, gain = None, 0
+    for sub, n in counts.items():
+        g = n * (len(sub) - 1) - (len(sub) + 1 + 2)
+        if g > gain or g == gain and best is not None and sub < best:
+            best, gain = sub, g
+    return best
+
+
+def replace(tokens, sub, code):
+    out, i = [], 0
+    while i < len(tokens):
+        if all(isinstance(t, str) for t in tokens[i:i + len(sub)]) and \
+                "".join(tokens[i:i + len(sub)]) == sub:
+            out.append(code)
+            i += len(sub)
+        else:
+            out.append(tokens[i])
+            i += 1
+    return out
+
+
+def pack(msgs):
+    texts = [list(text) for _, _, text in msgs]
+    entries = []
+    while len(entries) < MAX_ENTRIES:
+        sub = best_entry(texts)
+        if sub is None:
+            break
+        code = FIRST_CODE + len(entries)
+        texts = [replace(t, sub, code) for t in texts]
+        entries.append(sub)
+    return entries, texts
+
+
+def c_bytes(tokens):
+    return ", ".join("0x{:02X}".format(t if isinstance(t, int) else ord(t)) for t in tokens + ["\0"])
+
+
+def render(msgs, entries, texts):
+    plain = sum(len(text) + 1 for _, _, text in msgs) + 2 * len(msgs)
+    packed = sum(len(e) + 1 for e in entries) + 2 * len(entries) + \
+        sum(len(t) + 1 for t in texts) + 2 * len(texts)
+    out = ["// filename  ***************  msgs_packed.h  **********************",
+           "// Dictionary compressed message texts for msgs.c (MSG_TEXT + MSG_PACKED)",
+           "// Generated by tools/msgs_pack.py from msgs.def, do not edit.",
+           "// {} bytes of tables instead of {} for the plain texts".format(packed, plain),
+           ""]
+    out.append("static const unsigned char msgDict[] = {")
+    starts, pos = [], 0
+    for code, e in enumerate(entries, FIRST_CODE):
+        out.append("  {},  // 0x{:02X} \"{}\"".format(c_bytes(list(e)), code, e))
+        starts.append(pos)
+        pos += len(e) + 1
+    out.append("};")
+    out.append("static const unsigned short msgDictStart[] = {")
+    out.append("  " + ", ".join(str(s) for s in starts))
+    out.append("};")
+    out.append("")
+    out.append("static const unsigned char msgText[] = {")
+    starts, pos = [], 0
+    for (ident, _, _), t in zip(msgs, texts):
+        out.append("  {},  // {}".format(c_bytes(t), ident))
+        starts.append(pos)
+        pos += len(t) + 1
+    out.append("};")
+    out.append("static const unsigned short msgStart[MSG_COUNT] = {")
+    out.append("  " + ", ".join(str(s) for s in starts))
+    out.append("};")
+    return "\r\n".join(out) + "\r\n"
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("--check", action="store_true", help="only compare, don't write")
+    args = ap.parse_args()
+
+    msgs = read_def(os.path.join(SOURCES, "msgs.def"))
+    entries, texts = pack(msgs)
+    text = render(msgs, entries, texts)
+    path = os.path.join(SOURCES, "msgs_packed.h")
+
+    if args.check:
+        try:
+            with open(path, newline="") as f:
+                current = f.read()
+        except FileNotFoundError:
+            current = None
+        if current != text:
+            sys.exit("{} is out of date, run tools/msgs_pack.py".format(path))
+        return
+    with open(path, "w", newline="") as f:
+        f.write(text)
+    print(text.splitlines()[3][3:])
+
+
+if __name__ == "__main__":
+    main()
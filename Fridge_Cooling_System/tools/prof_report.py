@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+"""Report where the fridge controller spends its time, from PC samples.
+
+The firmware samples the interrupted PC on every real-time interrupt and
+answers the SCI command 'P' with one binary frame (see Sources/prof.h):
+
+    'P' 'F' count_hi count_lo  <count * 5 entry bytes>  lost_hi lost_lo  checksum
+
+    entry: page pc_hi pc_lo count_hi count_lo
+           (page 0: non-paged address, else PPAGE of the 0x8000 window)
+
+Each address range is charged to the procedure that contains it, from the
+OBJECT-ALLOCATION SECTION of the linker map (bin/Project.map, banked
+addresses printed as PPAGE:offset). Interrupt handlers are never sampled.
+
+Usage:
+    prof_report.py --port /dev/ttyUSB0          # send 'P', report
+    prof_report.py dump.bin                     # report a captured frame
+    prof_report.py dump.bin --map other.map -n 40
+
+Reading from a serial port needs pyserial.
+"""
+import argparse
+import bisect
+import os
+import re
+import sys
+
+PROC_LINE = re.compile(r"^\s+(\w+)\s+([0-9A-F]{4,6})\s+([0-9A-F]+)\s+\d+\s+\d+\s+\S+")
+MODULE_LINE = re.compile(r"^MODULE:\s+-- (\S+) --")
+
+
+def find_frame(data):
+    """Return ([(address, count)], lost) of the first valid frame in data."""
+    start = 0
+    while True:
+        start = data.find(b"PF", start)
+        if start < 0 or len(data) < start + 4:
+            raise ValueError("no profile frame found")
+        count = (data[start + 2] << 8) | data[start + 3]
+        end = start + 4 + 5 * count + 2
+        if len(data) > end and sum(data[start + 4:end]) & 0xFF == data[end]:
+            body = data[start + 4:end]
+            samples = []
+            for i in range(0, 5 * count, 5):
+                page, pc = body[i], (body[i + 1] << 8) | body[i + 2]
+                samples.append(((page << 16) | pc, (body[i + 3] << 8) | body[i + 4]))
+            return samples, (body[-2] << 8) | body[-1]
+        start += 1
+
+
+def parse_map(text):
+    """Sorted [(start, end, name, module)] of every procedure."""
+    procs, module, inside = [], "?", False
+    for line in text.splitlines():
+        m = MODULE_LINE.match(line)
+        if m:
+            module = m.group(1)
+            continue
+        if line.startswith("- "):
+            inside = line.startswith("- PROCEDURES")
+            continue
+        m = PROC_LINE.match(line)
+        if inside and m:
+            start = int(m.group(2), 16)
+            procs.append((start, start + max(int(m.group(3), 16), 1), m.group(1), module))
+    procs.sort()
+    return procs
+
+
+def lookup(procs, starts, addr):
+    i = bisect.bisect_right(starts, addr) - 1
+    if i >= 0 and addr < procs[i][1]:
+        return procs[i][2], procs[i][3]
+    return None
+
+
+def read_port(port, baud):
+    import serial  # pyserial
+    with serial.Serial(port, baud, timeout=5) as ser:
+        ser.reset_input_buffer()
+        ser.write(b"P")
+        data = b""
+        while True:
+            chunk = ser.read(4096)
+            if not chunk:
+                return data
+            data += chunk
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("file", nargs="?", help="captured dump (default: stdin)")
+    ap.add_argument("--port", help="serial port to request the dump from")
+    ap.add_argument("--baud", type=int, default=9600)
+    ap.add_argument("--map", default=os.path.join(here, "..", "bin", "Project.map"))
+    ap.add_argument("-n", type=int, default=25, help="functions to list")
+    args = ap.parse_args()
+
+    if args.port:
+        data = read_port(args.port, args.baud)
+    elif args.file:
+        with open(args.file, "rb") as f:
+            data = f.read()
+    else:
+        data = sys.stdin.buffer.read()
+    samples, lost = find_frame(data)
+
+    with open(args.map, errors="replace") as f:
+        procs = parse_map(f.read())
+    if not procs:
+        print("warning: no procedures in %s, link the project first" % args.map, file=sys.stderr)
+    starts = [p[0] for p in procs]
+
+    per_func = {}
+    total = sum(c for _, c in samples)
+    for addr, count in samples:
+        key = lookup(procs, starts, addr) or (
+            "?%02X:%04X" % (addr >> 16, addr & 0xFFFF) if addr > 0xFFFF else "?%04X" % addr, "")
+        per_func[key] = per_func.get(key, 0) + count
+
+    print("%d samples, %d lost (table full)" % (total, lost))
+    print("%8s %6s  %s" % ("samples", "%", "function"))
+    for (name, module), count in sorted(per_func.items(), key=lambda kv: -kv[1])[:args.n]:
+        print("%8d %6.1f  %s%s" % (count, 100.0 * count / total if total else 0.0, name,
+                                  "  (%s)" % module if module else ""))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+"""Capture the input recording of the fridge controller for host replay.
+
+The firmware answers the SCI command 'R' with one binary frame
+(see Sources/rec.h):
+
+    'R' 'T' flags len_hi len_lo  <len record bytes>  checksum
+
+Each record is a time delta in timer ticks (7 bits per byte, low first,
+bit 7 set on all but the last byte), the input number and its value.
+
+Usage:
+    rec_capture.py --port /dev/ttyUSB0 trace.bin   # send 'R', save the frame
+    rec_capture.py trace.bin                       # list a captured frame
+
+Replay with host/fridge_replay trace.bin. Reading from a serial port
+needs pyserial.
+"""
+import argparse
+import sys
+
+REC_FULL = 0x01
+TICK_HZ = 375000   # TCNT rate, 24 MHz bus / 64
+
+INPUTS = {0: "dip"}
+INPUTS.update({1 + r: "keypad%d" % r for r in range(4)})
+INPUTS.update({8 + c: "atd%d" % c for c in range(8)})
+INPUTS[16] = "sci"
+
+
+def find_frame(data):
+    """Return (flags, frame bytes, record bytes) of the first valid frame."""
+    start = 0
+    while True:
+        start = data.find(b"RT", start)
+        if start < 0 or len(data) < start + 5:
+            raise ValueError("no recording frame found")
+        n = (data[start + 3] << 8) | data[start + 4]
+        end = start + 5 + n
+        if len(data) > end and sum(data[start + 5:end]) & 0xFF == data[end]:
+            return data[start + 2], data[start:end + 1], data[start + 5:end]
+        start += 1
+
+
+def decode(records):
+    t = i = 0
+    while i < len(records):
+        dt = shift = 0
+        while records[i] & 0x80:
+            dt |= (records[i] & 0x7F) << shift
+            shift += 7
+            i += 1
+        dt |= records[i] << shift
+        t += dt
+        yield t, records[i + 1], records[i + 2]
+        i += 3
+
+
+def read_port(port, baud):
+    import serial  # pyserial
+    with serial.Serial(port, baud, timeout=5) as ser:
+        ser.reset_input_buffer()
+        ser.write(b"R")
+        data = b""
+        while True:
+            chunk = ser.read(4096)
+            if not chunk:
+                return data
+            data += chunk
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("file", help="trace file to write (--port) or read")
+    ap.add_argument("--port", help="serial port to request the recording from")
+    ap.add_argument("--baud", type=int, default=9600)
+    args = ap.parse_args()
+
+    if args.port:
+        flags, frame, records = find_frame(read_port(args.port, args.baud))
+        with open(args.file, "wb") as f:
+            f.write(frame)
+    else:
+        with open(args.file, "rb") as f:
+            flags, frame, records = find_frame(f.read())
+
+    events = list(decode(records))
+    print("%d inputs recorded%s" % (len(events), ", buffer full" if flags & REC_FULL else ""))
+    if not args.port:
+        for t, inp, v in events:
+            print("%10.4fs  %-8s 0x%02X" % (t / TICK_HZ, INPUTS.get(inp, str(inp)), v))
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""Set the fridge controller's clock and its set point schedule.
+
+The firmware keeps the time of day and the schedule in RAM (see
+Sources/sched.h), both are lost on reset. This sends, one command at a
+time and waiting for each answer:
+
+    'K' hhmmss              the host's local time
+    'W' z n hhmm sdd        one entry per ZONE:HHMM=OFFSET argument
+                            (entries numbered from 0 per zone)
+
+then prints the controller's report ('D'). A zone given with "-" clears
+its entries.
+
+Usage:
+    schedule.py --port /dev/ttyUSB0                         # clock only
+    schedule.py --port /dev/ttyUSB0 1:22:00=-8 1:06:00=+0   # pre-cool zone 1 at night
+    schedule.py --port /dev/ttyUSB0 2:-                     # clear zone 2
+
+Needs pyserial.
+"""
+import argparse
+import re
+import sys
+import time
+
+SLOTS = 4          # SCHED_SLOTS
+MAX_OFFSET = 20    # SCHED_MAX_OFFSET
+ENTRY = re.compile(r"^([12]):(?:(\d{1,2}):(\d\d)=([+-]\d{1,2})|-)$")
+
+
+def parse(args):
+    """{zone: [(hhmm, offset)]} from the command line."""
+    zones = {}
+    for arg in args:
+        m = ENTRY.match(arg)
+        if not m:
+            raise ValueError("bad entry %r, expected ZONE:HH:MM=OFFSET or ZONE:-" % arg)
+        zone = int(m.group(1))
+        entries = zones.setdefault(zone, [])
+        if m.group(2) is None:
+            continue
+        h, mi, off = int(m.group(2)), int(m.group(3)), int(m.group(4))
+        if h > 23 or mi > 59 or abs(off) > MAX_OFFSET:
+            raise ValueError("bad entry %r" % arg)
+        entries.append((h * 100 + mi, off))
+        if len(entries) > SLOTS:
+            raise ValueError("zone %d: at most %d entries" % (zone, SLOTS))
+    return zones
+
+
+def command(ser, text):
+    ser.write(text.encode())
+    time.sleep(0.3)   # commands are polled once per main loop pass
+    if b"?\r\n" in ser.read(ser.in_waiting):
+        raise RuntimeError("controller rejected %r" % text)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("entries", nargs="*", help="ZONE:HH:MM=OFFSET or ZONE:-")
+    ap.add_argument("--port", required=True, help="serial port of the controller")
+    ap.add_argument("--baud", type=int, default=9600)
+    args = ap.parse_args()
+    zones = parse(args.entries)
+
+    import serial  # pyserial
+    with serial.Serial(args.port, args.baud, timeout=2) as ser:
+        ser.reset_input_buffer()
+        command(ser, "K" + time.strftime("%H%M%S"))
+        for zone, entries in sorted(zones.items()):
+            for n in range(SLOTS):
+                hhmm, off = entries[n] if n < len(entries) else (9999, 0)
+                command(ser, "W%d%d%04d%+03d" % (zone, n, hhmm, off))
+        ser.reset_input_buffer()
+        ser.write(b"D")
+        time.sleep(0.5)
+        sys.stdout.write(ser.read(ser.in_waiting).decode("ascii", "replace"))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+"""Convert the fridge controller's event trace to a Chrome trace timeline.
+
+The firmware answers the SCI command 'T' with one binary frame
+(see Sources/trace.h):
+
+    'T' 'R' flags count_hi count_lo  <count * 5 entry bytes>  checksum
+
+    entry: time_hi time_lo id arg_hi arg_lo (TCNT, oldest first)
+    id:    [7:6] kind (0 mark, 1 begin, 2 end), [5:0] event
+
+The 16-bit TCNT stamps are unwrapped assuming consecutive entries are
+less than one counter period apart; the control law in the system tick
+is traced every 100 ms, so that holds while the timer interrupts run. Open the JSON in about:tracing or
+https://ui.perfetto.dev. ISR spans are on the "ISR" track, marks on "main".
+
+Usage:
+    trace2chrome.py --port /dev/ttyUSB0 -o trace.json   # send 'T', convert
+    trace2chrome.py dump.bin -o trace.json              # convert a capture
+
+Reading from a serial port needs pyserial.
+"""
+import argparse
+import json
+import sys
+
+TRACE_FROZEN, TRACE_WRAPPED = 0x01, 0x02
+MARK, BEGIN, END = 0, 1, 2
+
+EVENTS = {
+    1: "CONTROL",
+    2: "FAN1",
+    3: "FAN2",
+    4: "TICK",
+    5: "STOP",
+    6: "LOOP",
+    7: "DOOR",
+    8: "CMD",
+    9: "FAULT",
+}
+FAULTS = {1: "overheating", 2: "door", 3: "stop", 4: "EEPROM", 5: "stack"}
+
+TICK_US = 64 / 24.0   # TSCR2 = 0x06: prescaler 64 at a 24 MHz bus
+
+
+def find_frame(data):
+    """Return (flags, entry bytes) of the first valid frame in data."""
+    start = 0
+    while True:
+        start = data.find(b"TR", start)
+        if start < 0 or len(data) < start + 5:
+            raise ValueError("no trace frame found")
+        count = (data[start + 3] << 8) | data[start + 4]
+        end = start + 5 + 5 * count
+        if len(data) > end and sum(data[start + 5:end]) & 0xFF == data[end]:
+            return data[start + 2], data[start + 5:end]
+        start += 1
+
+
+def decode(entries):
+    """Yield (ticks since the first entry, kind, event, arg)."""
+    t = 0
+    last = None
+    for i in range(0, len(entries), 5):
+        tcnt = (entries[i] << 8) | entries[i + 1]
+        if last is not None:
+            t += (tcnt - last) & 0xFFFF
+        last = tcnt
+        ident = entries[i + 2]
+        yield t, ident >> 6, ident & 0x3F, (entries[i + 3] << 8) | entries[i + 4]
+
+
+def chrome(events, tick_us):
+    out = [
+        {"ph": "M", "pid": 1, "tid": 0, "name": "thread_name", "args": {"name": "main"}},
+        {"ph": "M", "pid": 1, "tid": 1, "name": "thread_name", "args": {"name": "ISR"}},
+    ]
+    open_span = None
+    for t, kind, ev, arg in events:
+        ts = round(t * tick_us, 2)
+        name = EVENTS.get(ev, "event%d" % ev)
+        if open_span and (kind != END or open_span != name):
+            # ISR left through a main() restart, close it here
+            out.append({"ph": "E", "pid": 1, "tid": 1, "ts": ts, "name": open_span})
+            open_span = None
+        if kind == BEGIN:
+            out.append({"ph": "B", "pid": 1, "tid": 1, "ts": ts, "name": name,
+                        "args": {"arg": arg}})
+            open_span = name
+        elif kind == END:
+            if open_span:
+                out.append({"ph": "E", "pid": 1, "tid": 1, "ts": ts, "name": name,
+                            "args": {"arg": arg}})
+                open_span = None
+        else:
+            args = {"arg": FAULTS.get(arg, arg) if ev == 9 else
+                           chr(arg) if ev == 8 and 0x20 <= arg < 0x7F else arg}
+            out.append({"ph": "i", "s": "t", "pid": 1, "tid": 0, "ts": ts, "name": name,
+                        "args": args})
+    return out
+
+
+def read_port(port, baud):
+    import serial  # pyserial
+    with serial.Serial(port, baud, timeout=5) as ser:
+        ser.reset_input_buffer()
+        ser.write(b"T")
+        data = b""
+        while True:
+            chunk = ser.read(4096)
+            if not chunk:
+                return data
+            data += chunk
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("file", nargs="?", help="captured dump (default: stdin)")
+    ap.add_argument("--port", help="serial port to request the dump from")
+    ap.add_argument("--baud", type=int, default=9600)
+    ap.add_argument("--tick-us", type=float, default=TICK_US,
+                    help="microseconds per TCNT tick (default %(default).4f)")
+    ap.add_argument("-o", "--output", help="JSON file (default: stdout)")
+    args = ap.parse_args()
+
+    if args.port:
+        data = read_port(args.port, args.baud)
+    elif args.file:
+        with open(args.file, "rb") as f:
+            data = f.read()
+    else:
+        data = sys.stdin.buffer.read()
+
+    flags, entries = find_frame(data)
+    events = list(decode(entries))
+    trace = {"traceEvents": chrome(events, args.tick_us),
+             "displayTimeUnit": "ms",
+             "otherData": {"frozen": bool(flags & TRACE_FROZEN),
+                           "wrapped": bool(flags & TRACE_WRAPPED)}}
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(trace, f, indent=0)
+    else:
+        json.dump(trace, sys.stdout, indent=0)
+    span = events[-1][0] * args.tick_us / 1000.0 if events else 0.0
+    print("%d events over %.1f ms%s%s" % (len(events), span,
+          ", frozen at a fault" if flags & TRACE_FROZEN else "",
+          ", older events lost" if flags & TRACE_WRAPPED else ""), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()